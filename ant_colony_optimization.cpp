@@ -1,6 +1,7 @@
 #include <utility>
 #include <stdio.h>
 #include <iostream>
+#include <fstream>
 #include <stdlib.h>
 #include "vector"
 #include "algorithm"
@@ -8,57 +9,101 @@
 #include "greedy_algorithm.h"
 #include "random_provider.h"
 #include "graph.h"
+#include "deadline.h"
+#include "thread_pool.h"
+#include "pheromone_trail.h"
+#include "arena.h"
+#include "counters.h"
+#include "trace.h"
 
 using namespace std;
 
-double **heuristicDistance;
-double ROUTE_RESTORE = 0.9;
-double **pheromones;
-double BETA = 5;
-double ALPHA = 1;
-double tauMAX;
-double RO = 0.1;
-double a;
-double tauMIN;
-vector<int> intCities;
+const double ROUTE_RESTORE = 0.9;
+const double BETA = 5;
+const double ALPHA = 1;
+const double RO = 0.1;
+/** Fraction of pheromone range of its city an edge has to exceed to count in lambda branching factor. */
+const double LAMBDA = 0.05;
+/** Branching factor under which colony is considered converged and pheromones are reinitialized. */
+const double STAGNATION_BRANCHING = 1.05;
+/** Iterations without improvement before branching factor is checked, after a restart best route alone stands out. */
+const int STAGNATION_MIN_ITERATIONS = 3;
+/** Number of starting cities of nearest neighbor tour used for initial tauMAX. */
+const int GREEDY_STARTS = 8;
+/** Iteration statistics of the last solve of antColonySolver, written by logColonyStatistics. */
+vector<IterationStatistics> colonyStatistics;
 
 /**
  * Initializes a heuristic matrix depending on the distance of the city from current. Further away cities are given a lower heuristic value to
  * decrease the later probability of picking that city
- * @param size - size of the cities
- * @param distanceMatrix - matrix of distances between cities
  */
-void initializeHeuristicDistances(int size, int **distanceMatrix) {
-    auto **hm = new double *[size];
-    for (int i = 0; i < size; i++) {
-        hm[i] = new double[size];
-    }
+void AntColonyOptimization::initializeHeuristicDistances() {
+    heuristicDistance = arena.allocateMatrix<double>(static_cast<size_t>(size));
     for (int i = 0; i < size; i++) {
         for (int j = i; j < size; j++) {
-            hm[i][j] = hm[j][i] = pow(1. / distanceMatrix[i][j], BETA);
+            heuristicDistance[i][j] = heuristicDistance[j][i] = pow(1. / distanceMatrix[i][j], BETA);
         }
     }
-    heuristicDistance = hm;
 };
 
 /**
  * Initializes pheromones on each edge of the graph. The values are set to default value of taumax which is calculated by the greedy algorithm below.
- * @param size Number of cities
+ * Pheromones are kept only for candidate edges, candidate lists have to be initialized before.
  */
-void initializePheromones(int size) {
-    auto **ph = new double *[size];
+void AntColonyOptimization::initializePheromones() {
+    pheromones.initialize(candidates, size, k, tauMAX);
+};
 
+/**
+ * Finds candidate list of every city and allocates choice information for every candidate edge.
+ *
+ * @param noOfCandidates Number of closest cities in candidate list
+ */
+void AntColonyOptimization::initializeCandidates(int noOfCandidates) {
+    k = noOfCandidates < size - 1 ? noOfCandidates : size - 1;
+    candidates = arena.allocate<int>(static_cast<size_t>(size) * k);
+    choiceInfo = arena.allocate<double>(static_cast<size_t>(size) * k);
+    extraChoice.assign(static_cast<unsigned long>(size), vector<double>());
+    TRACE_SCOPE("candidate_lists");
     for (int i = 0; i < size; i++) {
-        ph[i] = new double[size];
+        vector<int> neighbors = findNeighbors(i, k, distanceMatrix, size);
+        copy(neighbors.begin(), neighbors.end(), candidates + (long) i * k);
     }
+}
 
+/**
+ * Recomputes combined choice information tau^alpha * eta^beta of candidate edges. Called once per iteration after
+ * pheromone levels change, so ants only look values up while walking. In the same pass lambda branching factor is
+ * computed: for every city number of candidate edges with pheromone level above min + lambda * (max - min) of levels
+ * of its candidate edges, averaged over cities and divided by 2, number of edges a converged city keeps. Only best
+ * route deposits, so edges never on it share one level and factor above 1 counts edges of earlier best routes which
+ * did not evaporate yet. It reads as converged right after pheromones are initialized, so it is checked only once
+ * best route stopped improving for several iterations.
+ */
+void AntColonyOptimization::computeChoiceInformation() {
+    double branches = 0;
     for (int i = 0; i < size; i++) {
-        for (int j = i; j < size; j++) {
-            ph[i][j] = ph[j][i] = tauMAX;
+        double low = tauMAX, high = tauMIN;
+        for (int r = 0; r < k; r++) {
+            int j = candidates[(long) i * k + r];
+            double level = pheromones.candidateLevel(i, r);
+            choiceInfo[(long) i * k + r] = pow(level, ALPHA) * heuristicDistance[i][j];
+            low = min(low, level);
+            high = max(high, level);
+        }
+        double cutoff = low + LAMBDA * (high - low);
+        for (int r = 0; r < k; r++) {
+            if (pheromones.candidateLevel(i, r) >= cutoff) branches++;
+        }
+        const vector<pair<int, double>> &edges = pheromones.extraEdges(i);
+        extraChoice[i].resize(edges.size());
+        for (int r = 0, e = (int) edges.size(); r < e; r++) {
+            extraChoice[i][r] = pow(pheromones.extraLevel(i, r), ALPHA) * heuristicDistance[i][edges[r].first];
         }
     }
-    pheromones = ph;
-};
+    defaultChoice = pow(pheromones.defaultLevel(), ALPHA);
+    branchingFactor = size > 0 ? branches / (2. * size) : 0;
+}
 
 /**
  * The A factor represents the fraction of the tau max with respect to tau min, which is important as they are the maximal and minimal values of the pheromone path.
@@ -82,188 +127,243 @@ bool Route::operator<(const Route &other) const {
 }
 
 /**
- * Returns the best route from the list of routes in the ant colony.
+ * Creates colony with scratch memory for every worker of shared thread pool.
  *
- * @return Best route with smallest distance
+ * @param numberOfAnts Number of ants walking the graph in each iteration
+ * @param optimization Solve the colony belongs to
  */
-Route AntColony::getBestRoute() {
-    vector<Route> copy;
-    for (const auto &route : routes) {
-        copy.push_back(route);
+AntColony::AntColony(int numberOfAnts, const AntColonyOptimization &optimization) : numberOfAnts(numberOfAnts),
+                                                                                    optimization(optimization),
+                                                                                    distanceMatrix(
+                                                                                            optimization.distanceMatrix),
+                                                                                    size(optimization.size),
+                                                                                    seeds(nextSeed()) {
+    const Distances &distances = optimization.distances;
+    unique_ptr<KdTree> tree(distances.hasCoordinates() ? new KdTree(*distances.vertices) : nullptr);
+    for (int i = 0, workers = sharedThreadPool().size(); i < workers; i++) {
+        ants.emplace_back(size, tree.get());
     }
-    sort(copy.begin(), copy.end());
-
-    return copy[0];
 }
 
 /**
- * Every ant walks a graph and therefore one route is pushed on the route list.
+ * Returns the best route from the list of routes in the ant colony.
+ *
+ * @return Best route with smallest distance
  */
-void AntColony::processAnts() {
-    for (int i = 0; i < numberOfAnts; i++) {
-        routes.push_back(walkGraph());
-    }
+Route AntColony::getBestRoute() {
+    return *min_element(routes.begin(), routes.end());
 }
 
 /**
- * The ant makes a path of the graph, and gives it's passed route.
+ * Ants walk the graph concurrently on shared thread pool and their routes are collected on the route list. While
+ * ants walk, pheromones and choice information are only read. Every ant gets own random stream seeded in advance,
+ * so routes do not depend on scheduling. Ants which did not start before deadline expired are left out.
  *
- * @return Route of the ant that walked the graph.
+ * @param deadline Time budget of the algorithm
  */
-Route AntColony::walkGraph() {
-    int start = iRand(0, size - 1);
-    vector<int> route;
-    vector<bool> visited;
-
-    for (int i = 0; i < size; i++) {
-        visited.push_back(i == start);
+void AntColony::processAnts(Deadline &deadline) {
+    vector<unsigned long> antSeeds;
+    for (int i = 0; i < numberOfAnts; i++) {
+        antSeeds.push_back(seeds.nextSeed());
     }
 
-    double routeDistance = 0;
-    int current = start;
-    while (true) {
-        route.push_back(current);
-        if (route.size() == size) break;
-
-        int next = getNextVertex(current, visited);
-
-        visited[next] = true;
-        current = next;
+    vector<Route> walked(static_cast<unsigned long>(numberOfAnts));
+    vector<char> finished(static_cast<unsigned long>(numberOfAnts), 0);
+    sharedThreadPool().parallelFor(numberOfAnts, [&](int i, int worker) {
+        if (deadline.expired()) return;
+        TRACE_SCOPE("ant_walk");
+        Ant &ant = ants[worker];
+        ant.random.seed(antSeeds[i]);
+        walked[i] = walkGraph(ant);
+        finished[i] = 1;
+    });
+
+    routes.clear();
+    for (int i = 0; i < numberOfAnts; i++) {
+        if (finished[i]) routes.push_back(move(walked[i]));
     }
-
-    routeDistance = calculateTourDistance(route, distanceMatrix);
-
-    return Route(route, routeDistance);
 }
 
 /**
- * Returns true if there are no closest neighbors in the unvisited states.
+ * Prepares scratch memory for a new walk starting at given city.
  *
- * @param current Current city that is visited
- * @param visited List of visited cities so far.
- * @return True if one of the candidates exist and is unvisited on the graph.
+ * @param start Starting city
  */
-bool AntColony::noMoreCandidates(int current, vector<bool> visited) {
-    for (int candidate : getNeighbours(current)) {
-        if (!visited[candidate]) return false;
+void Ant::reset(int start) {
+    if (tree != nullptr) {
+        for (int city : route) {
+            tree->restore(city);
+        }
     }
-    return true;
+    route.clear();
+    fill(visited.begin(), visited.end(), false);
+    for (int i = 0, n = (int) unvisited.size(); i < n; i++) {
+        unvisited[i] = i;
+        position[i] = i;
+    }
+    visit(start);
 }
 
 /**
- * Sorting function that sorts the elements of a pair by the value in descending order.
+ * Marks city as visited and removes it from unvisited cities in constant time, and from k-d tree in time of its depth.
  *
- * @param a Pair a
- * @param b Pair b
- * @return true if the second value is greater for the first pair
+ * @param city Visited city
  */
-bool reverseSortByDistance(const pair<int, double> &a, const pair<int, double> &b) {
-    return (a.second > b.second);
+void Ant::visit(int city) {
+    visited[city] = true;
+    if (tree != nullptr) tree->remove(city);
+    int last = unvisited.back();
+    unvisited[position[city]] = last;
+    position[last] = position[city];
+    unvisited.pop_back();
+    route.push_back(city);
 }
 
 /**
- * If there are candidates unvisited in the candidate list for a certain city, probabilities for each city in the
- * candidate list are assigned, and the roulette wheel selection is applied.
+ * The ant makes a path of the graph, and gives it's passed route.
  *
- * @param current Current visiting city
- * @param visited List of visited cities.
- * @return next city to be visited
+ * @param ant Scratch memory and random stream of the ant
+ * @return Route of the ant that walked the graph.
  */
-int AntColony::nextCandidate(int current, vector<bool> visited) {
-    if (noMoreCandidates(current, visited)) return -1;
-
-    vector<pair<int, double>> probabilities = getProbabilities(current, getNeighbours(current), visited);
-    sort(probabilities.begin(), probabilities.end(), reverseSortByDistance);
+Route AntColony::walkGraph(Ant &ant) {
+    int start = ant.random.iRand(0, size - 1);
+    ant.unvisited.resize(static_cast<unsigned long>(size));
+    ant.reset(start);
 
-    double probability = fRand();
+    int current = start;
+    while (ant.route.size() < static_cast<size_t>(size)) {
+        int next = getNextVertex(current, ant);
+        ant.visit(next);
+        current = next;
+    }
+    COUNT(ACO_STEPS, size - 1);
 
-    for (auto &it : probabilities) {
-        probability -= it.second;
+    double routeDistance = calculateTourDistance(ant.route, distanceMatrix);
 
-        if (probability <= 0) {
-           return it.first;
-        }
-    }
-    return -1;
+    return Route(ant.route, routeDistance);
 }
 
 /**
- * Returns the next candidate for the city to be visited. First the list of candidates is explored and picked between
- * them, after that the other possibilities are included. Roulette wheel is done for the selection of the cities.
+ * If there are candidates unvisited in the candidate list for a certain city, roulette wheel selection is applied
+ * over precomputed choice information of unvisited candidates. Cumulative sums are built in one pass and the wheel
+ * is spun with binary search over them.
  *
  * @param current Current visiting city
- * @param visited List of visited cities
- * @return next city to be visited
+ * @param ant Ant making the step
+ * @return next city to be visited, -1 if all candidates are visited
  */
-int AntColony::getNextVertex(int current, vector<bool> visited) {
-    int nc = nextCandidate(current, visited);
-
-    if (nc != -1) {
-        return nc;
-    }
-
-    vector<pair<int, double>> probabilities = getProbabilities(current, intCities, visited);
-    sort(probabilities.begin(), probabilities.end(), reverseSortByDistance);
-    double probability = fRand();
+int AntColony::nextCandidate(int current, Ant &ant) {
+    const vector<bool> &visited = ant.visited;
+    vector<double> &cumulative = ant.cumulative;
+    const int *neighbours = optimization.candidates + (long) current * optimization.k;
+    const double *choices = optimization.choiceInfo + (long) current * optimization.k;
 
-    for (auto it = probabilities.begin(); it != probabilities.end(); ++it) {
-        probability -= it->second;
-
-        if (probability <= 0) {
-            return it->first;
+    double sum = 0;
+    int last = -1;
+    for (int r = 0, k = optimization.k; r < k; r++) {
+        if (!visited[neighbours[r]]) {
+            sum += choices[r];
+            last = r;
         }
+        cumulative[r] = sum;
     }
-    return -1;
+    if (last == -1) return -1;
+
+    // Visited candidates do not raise the sum, so first position exceeding the spin is always unvisited
+    double probability = ant.random.fRand() * sum;
+    auto it = upper_bound(cumulative.begin(), cumulative.begin() + last, probability);
+    return neighbours[it - cumulative.begin()];
 }
 
 /**
- * Gets the denominator that is the sum of all probabilities, to normalize it.
+ * Roulette wheel selection over all unvisited cities, used when candidate list is exhausted and coordinates of cities
+ * are not known. Edges which had pheromones deposited outside of candidate lists are spun first, with the part of
+ * their choice value above the default level. Remaining wheel holds every unvisited city with default pheromone
+ * level, built in one pass over unvisited cities without sorting.
+ *
  * @param current Current visiting city
- * @param visited List of visited cities
- * @return Normalization factor for the probabilities
+ * @param ant Ant making the step
+ * @return next city to be visited
  */
-double AntColony::getDenominator(int current, vector<bool> visited, vector<int> candidates) {
+int AntColony::nextUnvisited(int current, Ant &ant) {
+    const vector<int> &unvisited = ant.unvisited;
+    vector<double> &cumulative = ant.cumulative;
+    const double *heuristic = optimization.heuristicDistance[current];
+    const vector<double> &extraChoice = optimization.extraChoice[current];
+    double defaultChoice = optimization.defaultChoice;
+
+    const vector<pair<int, double>> &edges = optimization.pheromones.extraEdges(current);
+    double extraSum = 0;
+    for (int r = 0, e = (int) edges.size(); r < e; r++) {
+        int city = edges[r].first;
+        if (!ant.visited[city]) extraSum += extraChoice[r] - defaultChoice * heuristic[city];
+    }
+
     double sum = 0;
+    for (int r = 0, n = (int) unvisited.size(); r < n; r++) {
+        sum += defaultChoice * heuristic[unvisited[r]];
+        cumulative[r] = sum;
+    }
 
-    for (int vertex : candidates) {
-        if (visited[vertex]) continue;
-        sum += getProbability(current, vertex);
+    double probability = ant.random.fRand() * (extraSum + sum);
+    if (probability < extraSum) {
+        for (int r = 0, e = (int) edges.size(); r < e; r++) {
+            int city = edges[r].first;
+            if (ant.visited[city]) continue;
+            probability -= extraChoice[r] - defaultChoice * heuristic[city];
+            if (probability < 0) return city;
+        }
     }
-    return sum;
+    probability -= extraSum;
+
+    int last = (int) unvisited.size() - 1;
+    auto it = upper_bound(cumulative.begin(), cumulative.begin() + last, probability);
+    return unvisited[it - cumulative.begin()];
 }
 
 /**
- * Gets the probabilities for each city of the candidates list, that can or can't be visited.
- * @param current current visiting city
- * @param candidateList list of possible candidates for visiting
- * @param visited list of visited cities
- * @return probabilities for each city
+ * Unvisited city with the largest choice value, used when candidate list is exhausted and coordinates of cities are
+ * known, as in ant colony system. Cities outside of candidate lists share default pheromone level unless they had
+ * pheromones deposited, so the best of them is nearest unvisited city found in k-d tree of the ant, compared with
+ * few edges with deposited pheromones. Step costs a tree search instead of pass over all unvisited cities.
+ *
+ * @param current Current visiting city
+ * @param ant Ant making the step
+ * @return next city to be visited
  */
-vector<pair<int, double>> AntColony::getProbabilities(int current, vector<int> candidateList, vector<bool> visited) {
-    vector<pair<int, double>> probabilities;
-    double denominator = getDenominator(current, visited, candidateList);
-
-    for (int &c : candidateList) {
-        if (visited[c]) {
-            probabilities.emplace_back(make_pair(c, 0));
-        } else {
-            probabilities.emplace_back(make_pair(c, getProbability(current, c) / denominator));
+int AntColony::bestUnvisited(int current, Ant &ant) {
+    const double *heuristic = optimization.heuristicDistance[current];
+    const vector<double> &extraChoice = optimization.extraChoice[current];
+    const vector<pair<int, double>> &edges = optimization.pheromones.extraEdges(current);
+
+    int best = ant.tree->nearestActive(current);
+    double bestChoice = optimization.defaultChoice * heuristic[best];
+    for (int r = 0, e = (int) edges.size(); r < e; r++) {
+        int city = edges[r].first;
+        if (!ant.visited[city] && extraChoice[r] > bestChoice) {
+            best = city;
+            bestChoice = extraChoice[r];
         }
     }
-
-    return probabilities;
+    return best;
 }
 
 /**
- * Returns the probability of an ant to go along that path based on the current pheromone track powered by alpha and
- * heuristic powered by beta.
+ * Returns the next candidate for the city to be visited. First the list of candidates is explored and picked between
+ * them, after that the other possibilities are included. Roulette wheel is done for the selection of the cities.
  *
- * @param current current city visited
- * @param v second city
- * @return probability to go along that path
+ * @param current Current visiting city
+ * @param ant Ant making the step
+ * @return next city to be visited
  */
-double AntColony::getProbability(int current, int v) {
-    return pow(pheromones[current][v], ALPHA) * heuristicDistance[current][v];
+int AntColony::getNextVertex(int current, Ant &ant) {
+    int nc = nextCandidate(current, ant);
+
+    if (nc != -1) {
+        return nc;
+    }
+    COUNT(ACO_FALLBACKS, 1);
+    return ant.tree != nullptr ? bestUnvisited(current, ant) : nextUnvisited(current, ant);
 }
 
 /**
@@ -272,9 +372,10 @@ double AntColony::getProbability(int current, int v) {
  * @param distance Taumin and Taumax are calculated based on the distance provided, reversely proportional. They tend to
  * get better as the taumax is closer to the optimal solution.
  */
-void updateMinMaxParameters(double distance) {
+void AntColonyOptimization::updateMinMaxParameters(double distance) {
     tauMAX = 1. / (RO * distance);
     tauMIN = tauMAX / a;
+    pheromones.setLimits(tauMIN, tauMAX);
 }
 
 /**
@@ -283,23 +384,16 @@ void updateMinMaxParameters(double distance) {
  * @param tj City 2
  * @param d Amount to update the pheromone path
  */
-void update(int ti, int tj, double d) {
-    double level = pheromones[ti][tj] + d < tauMAX ? pheromones[ti][tj] + d : tauMAX;
-    pheromones[ti][tj] = pheromones[tj][ti] = level;
+void AntColonyOptimization::update(int ti, int tj, double d) {
+    pheromones.deposit(ti, tj, d);
 }
 
 /**
- * Updates the pheromones, the smallest amount is tauMIN.
+ * Updates the pheromones, the smallest amount is tauMIN. Evaporation is lazy, so only edges of best route are touched.
  * @param best Best route that updates the pheromone path.
  */
-void updatePheromoneLevels(Route best, int **distanceMatrix, int size) {
-    for (int i = 0; i < size; i++) {
-        for (int j = i; j < size; j++) {
-            double possibleLevel = (1 - RO) * pheromones[i][j];
-            double level = possibleLevel > tauMIN ? possibleLevel : tauMIN;
-            pheromones[i][j] = pheromones[j][i] = level;
-        }
-    }
+void AntColonyOptimization::updatePheromoneLevels(const Route &best) {
+    pheromones.evaporate(RO);
 
     int n = (int)best.vertices.size();
     for (int i = 0; i < n; i++) {
@@ -310,70 +404,71 @@ void updatePheromoneLevels(Route best, int **distanceMatrix, int size) {
     }
 }
 
-/**
- * Duplicates one route, creating a copy of another.
- * @param r Route to be copied
- * @return Copied route
- */
-Route* Route::duplicate(Route r) {
-    Route *result = new Route(r.vertices, r.distance);
-    return result;
-}
-
 /**
  * Runs the ant colony algorithm, iterating for a certain number of iterations with certain number of ants.
  * First every ant walks on the graph and places pheromones, then the pheromones evaporate and the route is updated
- * with the best route
+ * with the best route. Pheromones are reinitialized when lambda branching factor shows the colony converged and best
+ * route did not improve for several iterations, or when it did not improve for a fifth of iterations.
  *
  * @param noOfCandidates number of cities in the candidate list.
  * @param l Number of ants
  * @param maxiter  Number of iterations
+ * @param deadline Time budget, on expiry best route found so far is returned
  * @return Best route found.
  */
-vector<int> AntColonyOptimization::run(int noOfCandidates, int l, int maxiter) {
+vector<int> AntColonyOptimization::run(int noOfCandidates, int l, int maxiter, Deadline &deadline) {
+    PHASE_TIMER(ACO_TIMER);
 
-    for (int i = 0; i < size; i++) {
-        intCities.push_back(i);
-    }
-
-    //Initialization of all matrices and lists
-    initializeHeuristicDistances(size, distanceMatrix);
-    initializeCandidatesList(noOfCandidates, distanceMatrix, size);
+    //Initialization of all matrices and lists, arrays of previous run are released at once
+    arena.release();
+    initializeHeuristicDistances();
+    initializeCandidates(noOfCandidates);
     initializeParameters();
-    initializePheromones(size);
+    initializePheromones();
+    computeChoiceInformation();
 
     //Global best route
-    globalBest = nullptr;
+    hasGlobalBest = false;
+    statistics.clear();
     int changeCounter = 0;
+    AntColony colony(l, *this);
     for (int i = 0; i < maxiter; i++) {
+        TRACE_SCOPE("aco_iteration");
         //All ants make its path
-        AntColony colony(l, distanceMatrix, size);
-        colony.processAnts();
+        colony.processAnts(deadline);
+        if (colony.routes.empty()) break;
+        COUNT(ACO_ITERATIONS, 1);
         Route iterBest = colony.getBestRoute();
 
         //The tau min and tau max are updated with a better version
-        if (globalBest == nullptr || iterBest < *globalBest) {
-            globalBest = iterBest.duplicate(iterBest);
-            updateMinMaxParameters(globalBest->distance);
+        if (!hasGlobalBest || iterBest < globalBest) {
+            globalBest = iterBest;
+            hasGlobalBest = true;
+            updateMinMaxParameters(globalBest.distance);
             changeCounter = 0;
         }
 
 
-        if (changeCounter > 0.2 * maxiter) {
+        bool converged = changeCounter >= STAGNATION_MIN_ITERATIONS && branchingFactor < STAGNATION_BRANCHING;
+        bool restarted = converged || changeCounter > 0.2 * maxiter;
+        if (restarted) {
             changeCounter = 0;
-            initializePheromones(size);
+            initializePheromones();
+            COUNT(ACO_RESTARTS, 1);
+            if (converged) COUNT(ACO_CONVERGED_RESTARTS, 1);
         }
 
         //Updating the pheromone levels each time
-        updatePheromoneLevels(*globalBest, distanceMatrix, size);
+        updatePheromoneLevels(globalBest);
+        computeChoiceInformation();
         changeCounter++;
+        statistics.push_back({i, iterBest.distance, globalBest.distance, branchingFactor, restarted, converged});
     }
 
-    vector<int> v;
-    for (auto &vertex : globalBest->vertices) {
-        v.push_back(vertex);
-    }
-    return v;
+    // Deadline expired before any ant finished its walk
+    if (!hasGlobalBest) return greedyTour;
+
+    return globalBest.vertices;
 };
 
 /**
@@ -381,24 +476,49 @@ vector<int> AntColonyOptimization::run(int noOfCandidates, int l, int maxiter) {
  * Taumin is the least number for pheromones
  */
 void AntColonyOptimization::initializeParameters() {
-    double greedy = calculateTourDistance(greedyAlgorithm(distanceMatrix, size), distanceMatrix);
+    greedyTour = multiStartGreedy(distances, size, GREEDY_STARTS);
+    double greedy = calculateTourDistance(greedyTour, distanceMatrix);
     tauMAX = 1. / (RO * greedy);
     a = calculateA(size);
     tauMIN = tauMAX / a;
+    pheromones.setLimits(tauMIN, tauMAX);
 }
 
 
 /**
  * Starts the min max ant system algorithm
+ *
+ * @param distanceMatrix Distance matrix
+ * @param vertices Coordinates of cities, may be empty
+ * @param size Size of TSP problem
+ * @param deadline Time budget of the algorithm
+ * @return Best route found
  */
-vector<int> antColonySolver(int **distanceMatrix, int size) {
+vector<int> antColonySolver(int **distanceMatrix, const vector<Vertex> &vertices, int size, Deadline &deadline) {
     int candidateList = (int) (size / 5);
     int numberOfAnts = 30;
     int maxiter = 100;
 
 
-    AntColonyOptimization a(distanceMatrix, size);
-    vector<int> route = a.run(candidateList, numberOfAnts, maxiter);
+    AntColonyOptimization a(distanceMatrix, vertices, size);
+    vector<int> route = a.run(candidateList, numberOfAnts, maxiter, deadline);
+    colonyStatistics = a.statistics;
 
     return route;
+}
+
+/**
+ * Writes statistics of the last ant colony solve next to the solution log, to /logs/<file>.aco, line per iteration:
+ *  <iteration> <iteration best> <global best> <branching factor> <restarted> <converged>
+ * Nothing is written when ant colony did not run.
+ *
+ * @param file Name of solution log without extension
+ */
+void logColonyStatistics(const string &file) {
+    if (colonyStatistics.empty()) return;
+    ofstream f("./logs/" + file + ".aco");
+    for (const IterationStatistics &s : colonyStatistics) {
+        f << s.iteration << " " << s.iterationBest << " " << s.globalBest << " " << s.branchingFactor << " "
+          << s.restarted << " " << s.converged << endl;
+    }
 }
\ No newline at end of file
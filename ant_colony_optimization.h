@@ -3,14 +3,17 @@
 
 #include "vector"
 #include "map"
+#include "memory"
+#include "string"
 #include "graph.h"
+#include "kd_tree.h"
+#include "deadline.h"
+#include "random_provider.h"
+#include "arena.h"
+#include "pheromone_trail.h"
 
 using namespace std;
 
-void initializeHeuristicDistances(int size, int **distanceMatrix);
-
-void initializePheromones(int size);
-
 double calculateA(int size);
 
 class Route {
@@ -22,58 +25,143 @@ public:
 
     Route(vector<int> vertices, double distance) : vertices(vertices), distance(distance) {};
 
-    Route() {};
+    Route() : distance(0) {};
+};
 
-    Route *duplicate(Route r);
+/**
+ * Scratch memory of one worker walking the graph, allocated once and reused by every ant the worker builds.
+ */
+class Ant {
+public:
+    vector<bool> visited;
+    vector<int> route;
+    /** Unvisited cities in no particular order, with position of every city in it for constant time removal. */
+    vector<int> unvisited;
+    vector<int> position;
+    /** Cumulative choice values of candidates or unvisited cities, reused between steps. */
+    vector<double> cumulative;
+    /** Own copy of k-d tree with visited cities removed, nullptr when coordinates are not known. */
+    unique_ptr<KdTree> tree;
+    /** Random stream, reseeded for every ant so routes do not depend on which worker builds them. */
+    RandomStream random;
+
+    Ant(int size, const KdTree *tree) : visited(static_cast<unsigned long>(size)),
+                                        unvisited(static_cast<unsigned long>(size)),
+                                        position(static_cast<unsigned long>(size)),
+                                        cumulative(static_cast<unsigned long>(size)),
+                                        tree(tree != nullptr ? new KdTree(*tree) : nullptr), random(0) {
+        route.reserve(static_cast<unsigned long>(size));
+    };
+
+    void reset(int start);
+
+    void visit(int city);
 };
 
+class AntColonyOptimization;
+
 class AntColony {
 public:
     vector<Route> routes;
     int numberOfAnts;
+    /** Solve whose pheromones and choice information ants read while walking. */
+    const AntColonyOptimization &optimization;
     int **distanceMatrix;
     int size;
+    /** Scratch memory of every worker of the thread pool. */
+    vector<Ant> ants;
+    /** Stream of seeds for ants, so colony does not touch global generator while walking. */
+    RandomStream seeds;
 
-    AntColony(int numberOfAnts, int **distanceMatrix, int size) : numberOfAnts(numberOfAnts), distanceMatrix(distanceMatrix), size(size) {};
+    AntColony(int numberOfAnts, const AntColonyOptimization &optimization);
 
     Route getBestRoute();
 
-    void processAnts();
+    void processAnts(Deadline &deadline);
 
-    Route walkGraph();
+    Route walkGraph(Ant &ant);
 
-    bool noMoreCandidates(int current, vector<bool> visited);
+    int nextCandidate(int current, Ant &ant);
 
-    int nextCandidate(int current, vector<bool> visited);
+    int nextUnvisited(int current, Ant &ant);
 
-    int getNextVertex(int current, vector<bool> visited);
+    int bestUnvisited(int current, Ant &ant);
 
-    double getDenominator(int current, vector<bool> visited, vector<int> candidates);
-
-    vector<pair<int, double>> getProbabilities(int current, vector<int> candidateList, vector<bool> visited);
-
-    double getProbability(int current, int v);
+    int getNextVertex(int current, Ant &ant);
 };
 
-void updateMinMaxParameters(double distance);
-
-void update(int ti, int tj, double d);
-
-void updatePheromoneLevels(Route best, int **distanceMatrix, int size);
+/**
+ * Statistics of one iteration of ant colony, collected for tuning of time budgets.
+ */
+struct IterationStatistics {
+    int iteration;
+    double iterationBest;
+    double globalBest;
+    /** Average lambda branching factor over candidate lists, normalized so converged colony has 1. */
+    double branchingFactor;
+    bool restarted;
+    /** Restart was caused by branching factor, not by missing improvement. */
+    bool converged;
+};
 
+/**
+ * One solve of min max ant system. All state of the solve is owned by the instance and its arrays come from one
+ * arena released together with it, so several solves can run in the same process at once.
+ */
 class AntColonyOptimization {
 public:
-    Route *globalBest;
+    Route globalBest;
+    bool hasGlobalBest = false;
+    vector<int> greedyTour;
     int **distanceMatrix;
+    /** Distances backed by matrix, with coordinates of cities when they are known. */
+    Distances distances;
     int size;
 
-    AntColonyOptimization(int **distanceMatrix, int size) : distanceMatrix(distanceMatrix), size(size) {};
-
-    vector<int> run(int noOfCandidates, int l, int maxiter);
+    double tauMAX = 0;
+    double tauMIN = 0;
+    double a = 0;
+    PheromoneTrail pheromones;
+    /** Heuristic value of every edge, inverse distance powered by beta. */
+    double **heuristicDistance = nullptr;
+    /** Candidate list of every city, k consecutive cities per city. */
+    int *candidates = nullptr;
+    int k = 0;
+    /** Combined choice information tau^alpha * eta^beta for every candidate edge, aligned with candidate lists. */
+    double *choiceInfo = nullptr;
+    /** Choice information of edges outside of candidate lists which had pheromones deposited, aligned with them. */
+    vector<vector<double>> extraChoice;
+    /** Choice information of other edges without heuristic part, they share pheromone level. */
+    double defaultChoice = 0;
+    /** Lambda branching factor of current pheromone levels, updated together with choice information. */
+    double branchingFactor = 0;
+    vector<IterationStatistics> statistics;
+    Arena arena;
+
+    AntColonyOptimization(int **distanceMatrix, const vector<Vertex> &vertices, int size)
+            : distanceMatrix(distanceMatrix), distances(distanceMatrix, vertices), size(size) {};
+
+    vector<int> run(int noOfCandidates, int l, int maxiter, Deadline &deadline);
 
     void initializeParameters();
+
+    void initializeHeuristicDistances();
+
+    void initializeCandidates(int noOfCandidates);
+
+    void initializePheromones();
+
+    void computeChoiceInformation();
+
+    void updateMinMaxParameters(double distance);
+
+    void update(int ti, int tj, double d);
+
+    void updatePheromoneLevels(const Route &best);
 };
 
-vector<int> antColonySolver(int **distanceMatrix, int size);
+vector<int> antColonySolver(int **distanceMatrix, const vector<Vertex> &vertices, int size, Deadline &deadline);
+
+void logColonyStatistics(const string &file);
 
 #endif //TSP_FINAL_ANT_COLONY_OPTIMIZATION_H
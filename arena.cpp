@@ -0,0 +1,51 @@
+#include <cstdint>
+#include "arena.h"
+
+using namespace std;
+
+Arena::~Arena() {
+    release();
+}
+
+/**
+ * Frees all memory allocated from arena, previously returned pointers become invalid.
+ */
+void Arena::release() {
+    for (char *block : blocks) {
+        delete[] block;
+    }
+    blocks.clear();
+    current = nullptr;
+    remaining = 0;
+    used = 0;
+}
+
+/**
+ * @return Number of bytes handed out since arena was created or released
+ */
+size_t Arena::bytesUsed() const {
+    return used;
+}
+
+/**
+ * Takes aligned memory from current block, requests larger than block size get a block of their own.
+ *
+ * @param bytes Number of bytes
+ * @param alignment Alignment of returned memory
+ * @return Pointer to memory
+ */
+void *Arena::allocateBytes(size_t bytes, size_t alignment) {
+    size_t padding = current == nullptr ? 0 : (alignment - (uintptr_t) current % alignment) % alignment;
+    if (current == nullptr || padding + bytes > remaining) {
+        size_t size = bytes + alignment > blockSize ? bytes + alignment : blockSize;
+        blocks.push_back(new char[size]);
+        current = blocks.back();
+        remaining = size;
+        padding = (alignment - (uintptr_t) current % alignment) % alignment;
+    }
+    char *memory = current + padding;
+    current = memory + bytes;
+    remaining -= padding + bytes;
+    used += bytes;
+    return memory;
+}
@@ -0,0 +1,69 @@
+#ifndef TSP_FINAL_ARENA_H
+#define TSP_FINAL_ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Bump allocator owning all arrays of one solve. Arrays are never freed one by one, whole memory is released at once
+ * when arena is released or destroyed, so a solve can not leak memory into the next one.
+ */
+class Arena {
+public:
+    explicit Arena(size_t blockSize = 1 << 20) : blockSize(blockSize), current(nullptr), remaining(0), used(0) {};
+
+    Arena(const Arena &) = delete;
+
+    Arena &operator=(const Arena &) = delete;
+
+    ~Arena();
+
+    /**
+     * Allocates array of trivially destructible values, values are value initialized (zero for numbers).
+     *
+     * @param count Number of values
+     * @return Pointer to first value
+     */
+    template<typename T>
+    T *allocate(size_t count) {
+        T *values = static_cast<T *>(allocateBytes(count * sizeof(T), alignof(T)));
+        for (size_t i = 0; i < count; i++) {
+            new(values + i) T();
+        }
+        return values;
+    }
+
+    /**
+     * Allocates square matrix as row pointers into one contiguous array.
+     *
+     * @param size Number of rows and columns
+     * @return Matrix
+     */
+    template<typename T>
+    T **allocateMatrix(size_t size) {
+        T **rows = allocate<T *>(size);
+        T *values = allocate<T>(size * size);
+        for (size_t i = 0; i < size; i++) {
+            rows[i] = values + i * size;
+        }
+        return rows;
+    }
+
+    void release();
+
+    size_t bytesUsed() const;
+
+private:
+    void *allocateBytes(size_t bytes, size_t alignment);
+
+    vector<char *> blocks;
+    size_t blockSize;
+    char *current;
+    size_t remaining;
+    size_t used;
+};
+
+#endif //TSP_FINAL_ARENA_H
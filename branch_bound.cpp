@@ -8,354 +8,606 @@
 #include <random>
 #include <algorithm>
 #include <climits>
+#include <limits>
 #include <list>
+#include <thread>
 #include "graph.h"
 #include "branch_bound.h"
+#include "christofides.h"
+#include "held_karp.h"
+#include "opt2local.h"
 #include "random_provider.h"
+#include "deadline.h"
+#include "counters.h"
+#include "trace.h"
+#include "thread_pool.h"
 
 using namespace std;
 
+/** Memory for frontier nodes, search continues depth-first without growing frontier when it is exhausted */
+const size_t FRONTIER_MEMORY = (size_t) 256 << 20;
+/** Frontier nodes per worker expanded best-first before parallel search deals them out */
+const int SEED_NODES = 8;
+/** Nodes expanded in one round of deterministic search */
+const int DETERMINISTIC_BATCH = 64;
+/** Largest instance solved by Held-Karp dynamic programming, which takes milliseconds up to this size */
+const int HELD_KARP_CITIES = 16;
+/** Subgradient iterations for the root, which starts with zero penalties */
+const int ROOT_ITERATIONS = 300;
+/** Subgradient iterations for other nodes, which start with penalties of their parent */
+const int NODE_ITERATIONS = 20;
+/** Initial step factors of subgradient optimization */
+const double ROOT_STEP = 2.0;
+const double NODE_STEP = 0.5;
+/** Decay of step factor after every iteration */
+const double STEP_DECAY = 0.95;
+
 /**
- * Fills the vector from 0 to size - 1 with the same values
- * @param size  size of the vector
- * @return  filled vector
+ * Deletes all nodes created by the pool.
  */
-vector<int> fillVector(int size) {
-    vector<int> v;
-    for (int i = 0; i < size; i++) {
-        v.push_back(i);
+NodePool::~NodePool() {
+    for (CityNode *node : nodes) {
+        delete node;
     }
-
-    return v;
 }
 
 /**
- * Sets certain row values to infinity.
- * @param matrix Matrix given for adding infinity to a certain row
- * @param position position of the row
- * @param size size of the quadratic matrix
+ * Provides node with matrix, recycled one if available.
+ * @return Node with allocated penalties of undefined content
  */
-void rowInfinity(int **matrix, int position, int size) {
-    for (int j = 0; j < size; j++) {
-        matrix[position][j] = INT_MAX;
+CityNode *NodePool::acquire() {
+    if (!released.empty()) {
+        CityNode *node = released.back();
+        released.pop_back();
+        return node;
     }
+    CityNode *node = new CityNode();
+    node->penalties = arena.allocate<double>(static_cast<size_t>(size));
+    nodes.push_back(node);
+    return node;
 }
 
 /**
- * Sets a certain column values to infinity
- * @param matrix  Matrix given for adding infinity to a certain column
- * @param position Position of the column
- * @param size Size of the quadratic matrix
+ * Returns node to the pool, its penalties are reused by next acquired node.
+ * @param node Node no longer needed
  */
-void columnInfinity(int **matrix, int position, int size) {
-    for (int j = 0; j < size; j++) {
-        matrix[j][position] = INT_MAX;
-    }
+void NodePool::release(CityNode *node) {
+    node->path.clear();
+    node->notUsed.clear();
+    released.push_back(node);
 }
 
 /**
- * Copies one vector to another
- * @param path vector to be copied
- * @return copied vector
+ * @return Approximate bytes of nodes created by the pool, including their paths
  */
-vector<int> copyVector(vector<int> path) {
-    vector<int> v;
-    for (unsigned long i = 0, size = path.size(); i < size; i++) {
-        v.push_back(path[i]);
-    }
+size_t NodePool::bytesUsed() const {
+    return arena.bytesUsed() + nodes.size() * (sizeof(CityNode) + 2 * size * sizeof(int));
+}
 
-    return v;
+/**
+ * @return Approximate bytes of one node with its penalties and paths, independent of which pool holds it
+ */
+size_t NodePool::nodeBytes() const {
+    return sizeof(CityNode) + size * (2 * sizeof(int) + sizeof(double));
 }
 
 /**
- * Copies one matrix to another
- * @param old Matrix to be copied
- * @param size Size of the quadratic matrix
- * @return copied matrix
+ * Prepares worker for the instance.
+ * @param distanceMatrix Distance matrix between cities
+ * @param size Number of cities
  */
-int **copyMatrix(int **old, int size) {
-    int **matrix = new int *[size];
-    for (int i = 0; i < size; ++i) {
-        matrix[i] = new int[size];
+SearchWorker::SearchWorker(int **distanceMatrix, int size)
+        : distanceMatrix(distanceMatrix), size(size), pool(size), degree(size), treeParent(size), key(size),
+          link(size), bestPenalties(size) {}
 
-        for (int j = 0; j < size; ++j) {
-            matrix[i][j] = old[i][j];
-        }
+/**
+ * Keeps tour as found if it is shorter than incumbent known to the worker.
+ * @param tour Complete tour
+ */
+void SearchWorker::improve(const vector<int> &tour) {
+    int length = calculateTourDistance(tour, distanceMatrix);
+    if (length < upper) {
+        upper = length;
+        found = tour;
     }
-    return matrix;
 }
 
 /**
- * Creates a cost matrix by setting the diagonal values to infinity.
- * @param distanceMatrix Distance matrix between cities
- * @param size Size of the distance matrix (quadratic)
- * @return Cost matrix with distances between cities that are not paths to itself
+ * Creates root node in city 0 with zero penalties.
+ * @param deadline Time budget of the search
+ * @return Root node
  */
-int **createCostMatrix(int **distanceMatrix, int size) {
-    int **costMatrix = new int *[size];
-    for (int i = 0; i < size; ++i) {
-        costMatrix[i] = new int[size];
-
-        for (int j = 0; j <= i; ++j) {
-            if (j == i) {
-                costMatrix[i][j] = INT_MAX;
-            } else {
-                costMatrix[i][j] = costMatrix[j][i] = distanceMatrix[i][j];
-            }
-        }
+CityNode *SearchWorker::createRoot(Deadline &deadline) {
+    CityNode *root = pool.acquire();
+    fill(root->penalties, root->penalties + size, 0.0);
+    root->length = 0;
+    root->path.push_back(0);
+    for (int i = 1; i < size; ++i) {
+        root->notUsed.push_back(i);
     }
-    return costMatrix;
+    bound(root, ROOT_ITERATIONS, ROOT_STEP, deadline);
+    return root;
 }
 
 /**
- * Reduces a matrix and updates the cost of reduction.
- * @param matrix  Matrix that is reduced
- * @param size Size of the matrix
- * @param cost Cost of reduction of matrix
- * @return Reduced matrix
+ * Creates child moving from parent to one of its unused cities and bounds it starting from parent's penalties.
+ * @param parent Expanded node
+ * @param index Position of the city in parent's unused cities
+ * @param deadline Time budget of the search
+ * @return Child node
  */
-int **reduceMatrix(int **matrix, int size, int *cost) {
-    for (int i = 0; i < size; i++) {
-        int min = -1;
-        for (int j = 0; j < size; j++) {
-            if (i == j) continue;
-            min = (min == -1 || min > matrix[i][j]) ? matrix[i][j] : min;
-        }
+CityNode *SearchWorker::createChild(CityNode *parent, int index, Deadline &deadline) {
+    CityNode *node = pool.acquire();
+    int city = parent->notUsed[index];
+    node->path = parent->path;
+    node->path.push_back(city);
+    node->notUsed = parent->notUsed;
+    node->notUsed.erase(node->notUsed.begin() + index);
+    node->length = parent->length + distanceMatrix[parent->position()][city];
+    copy(parent->penalties, parent->penalties + size, node->penalties);
+    bound(node, NODE_ITERATIONS, NODE_STEP, deadline);
+    return node;
+}
 
-        if (min != INT_MAX && min != 0) {
-            *cost += min;
-            for (int j = 0; j < size; j++) {
-                if (i == j) {
-                    matrix[i][j] = INT_MAX;
-                    continue;
-                }
+/**
+ * Computes 1-tree of a node under its penalties. Unused cities are joined by minimum spanning tree with edge weights
+ * increased by penalties of both ends, and the tree is connected to current position and to city 0 by their cheapest
+ * edges, which are two distinct edges of city 0 in the root. Any completion of the partial tour is such a structure
+ * with all unused cities of degree 2, so the value is a lower bound of every completion for any penalties.
+ * @param node Node with at least two unused cities
+ * @return Length of the partial tour plus 1-tree weight minus twice the sum of penalties
+ */
+double SearchWorker::oneTree(CityNode *node) {
+    vector<int> &rest = node->notUsed;
+    const double *penalty = node->penalties;
+    int m = (int) rest.size();
+    double value = node->length;
+    for (int i = 0; i < m; i++) {
+        degree[rest[i]] = 0;
+        value -= 2 * penalty[rest[i]];
+        key[i] = numeric_limits<double>::max();
+        link[i] = -1;
+    }
 
-                matrix[i][j] = (matrix[i][j] == INT_MAX) ? matrix[i][j] : matrix[i][j] - min;
+    key[0] = 0;
+    for (int added = 0; added < m; added++) {
+        int u = -1;
+        for (int i = added; i < m; i++) {
+            if (u == -1 || key[i] < key[u]) u = i;
+        }
+        swap(key[added], key[u]);
+        swap(link[added], link[u]);
+        /* keeps cities in tree order at the front of the list */
+        swap(rest[added], rest[u]);
+        int city = rest[added];
+        value += key[added];
+        treeParent[city] = link[added];
+        if (link[added] != -1) {
+            degree[city]++;
+            degree[link[added]]++;
+        }
+        for (int i = added + 1; i < m; i++) {
+            double weight = distanceMatrix[city][rest[i]] + penalty[city] + penalty[rest[i]];
+            if (weight < key[i]) {
+                key[i] = weight;
+                link[i] = city;
             }
         }
     }
 
-    for (int i = 0; i < size; i++) {
-        int min = -1;
-        for (int j = 0; j < size; j++) {
-            if (i == j) continue;
-            min = (min == -1 || min > matrix[j][i]) ? matrix[j][i] : min;
-        }
-        if (min != INT_MAX && min != 0) {
-            *cost += min;
-            for (int j = 0; j < size; j++) {
-                if (i == j) {
-                    continue;
-                }
-                matrix[j][i] = (matrix[j][i] == INT_MAX) ? matrix[j][i] : matrix[j][i] - min;
+    int last = node->position(), first = node->path[0];
+    double cheapest[2] = {numeric_limits<double>::max(), numeric_limits<double>::max()};
+    ends[0] = ends[1] = -1;
+    for (int city : rest) {
+        double toLast = distanceMatrix[last][city] + penalty[city];
+        double toFirst = distanceMatrix[first][city] + penalty[city];
+        if (last == first) {
+            if (toLast < cheapest[0]) {
+                cheapest[1] = cheapest[0];
+                ends[1] = ends[0];
+                cheapest[0] = toLast;
+                ends[0] = city;
+            } else if (toLast < cheapest[1]) {
+                cheapest[1] = toLast;
+                ends[1] = city;
+            }
+        } else {
+            if (toLast < cheapest[0]) {
+                cheapest[0] = toLast;
+                ends[0] = city;
+            }
+            if (toFirst < cheapest[1]) {
+                cheapest[1] = toFirst;
+                ends[1] = city;
             }
         }
     }
-
-    return matrix;
+    degree[ends[0]]++;
+    degree[ends[1]]++;
+    return value + cheapest[0] + cheapest[1];
 }
 
-/** Upper bound of cost. All nodes will be deleted that have a higher cost than this.*/
-int upper = INT_MAX;
-
-/** Leaf nodes, possible expansion nodes for finding a solution.*/
-list<CityNode*> leafs;
-
-
 /**
- * Check if the node does not have any children.
- * @return true if the node is leaf
+ * Completes partial tour along the last 1-tree, valid only when every unused city has degree 2 in it, so the tree is a
+ * path between its two ends.
+ * @param node Bounded node
+ * @return Complete tour
  */
-bool CityNode::isLeaf() {
-    return children.empty();
-};
+vector<int> SearchWorker::treeTour(CityNode *node) {
+    vector<int> adjacent(2 * size, -1);
+    for (int city : node->notUsed) {
+        int parent = treeParent[city];
+        if (parent == -1) continue;
+        adjacent[2 * city + (adjacent[2 * city] != -1)] = parent;
+        adjacent[2 * parent + (adjacent[2 * parent] != -1)] = city;
+    }
+    vector<int> tour = node->path;
+    int previous = -1, city = ends[0];
+    for (int i = 0; i < (int) node->notUsed.size(); i++) {
+        tour.push_back(city);
+        int next = adjacent[2 * city] != previous ? adjacent[2 * city] : adjacent[2 * city + 1];
+        previous = city;
+        city = next;
+    }
+    return tour;
+}
 
 /**
- * Branches current node into children, and puts them into the leafs array, therefore deleting it's place in the leafs array since it branched
- * and has no children anymore.
+ * Bounds node with subgradient optimization of its penalties. Penalty of every unused city moves by its degree in the
+ * 1-tree minus 2, scaled with step proportional to the gap between the incumbent and the current value. Best
+ * penalties are kept in the node for its children. If 1-tree is a tour, it is the best completion of the node and it
+ * is offered as the incumbent, which makes the node prunable. Nodes with at most one unused city are bounded exactly.
+ * Every 1-tree is a lower bound, so optimization stops after the current iteration once deadline expires.
+ * @param node Node with penalties to start from
+ * @param iterations Maximum number of iterations
+ * @param step Initial step factor
+ * @param deadline Time budget of the search
  */
-void CityNode::branch() {
-
-    if (notUsed.empty()) return;
+void SearchWorker::bound(CityNode *node, int iterations, double step, Deadline &deadline) {
+    int m = (int) node->notUsed.size();
+    if (m <= 1) {
+        vector<int> tour = node->path;
+        tour.insert(tour.end(), node->notUsed.begin(), node->notUsed.end());
+        node->cost = calculateTourDistance(tour, distanceMatrix);
+        improve(tour);
+        return;
+    }
 
-    for (int i = 0; i < notUsed.size(); i++) {
-        vector<int> v = copyVector(notUsed);
-        int pos = v[i];
-        v.erase(v.begin() + i);
-        shuffle(v.begin(), v.end(), std::mt19937(std::random_device()()));
-        CityNode *node = new CityNode(this, v, copyMatrix(matrix, size), 0, size, pos);
-        node->getCost();
+    double best = -numeric_limits<double>::max();
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        double value = oneTree(node);
+        if (value > best) {
+            best = value;
+            copy(node->penalties, node->penalties + size, bestPenalties.begin());
+        }
+        if (best > upper - 1 || deadline.expired()) break;
 
-        if (node->cost < upper) {
-            leafs.push_front(node);
-            children.push_back(node);
+        int norm = 0;
+        for (int city : node->notUsed) {
+            norm += (degree[city] - 2) * (degree[city] - 2);
+        }
+        if (norm == 0) {
+            improve(treeTour(node));
+            break;
+        }
+        double move = step * (upper - value) / norm;
+        for (int city : node->notUsed) {
+            node->penalties[city] += move * (degree[city] - 2);
         }
+        step *= STEP_DECAY;
     }
-
-    leafs.remove(this);
-};
+    copy(bestPenalties.begin(), bestPenalties.end(), node->penalties);
+    double cost = ceil(best - 1e-6);
+    node->cost = cost > INT_MAX ? INT_MAX : (int) cost;
+}
 
 /**
- * Sets the row and column of the node and parent to infinity, as well as all the costs from children to parent.
- * Reduces the matrix and calculates the total cost of the node by adding parent cost, reduction cost and the cost from
- * going from parent node to child node.
+ * Creates children of a node, children whose bound can still improve the incumbent are kept, ordered from the least
+ * promising one, so the most promising one is at the back of the worker's deque. Once deadline expires no more
+ * children are created, search is over by then.
+ * @param node Expanded node
+ * @param children Vector receiving kept children
+ * @param deadline Time budget of the search
  */
-void CityNode::getCost() {
-    rowColumnInfinity();
-    setParentInfinity();
-    int reduceCost = 0;
-    matrix = reduceMatrix(matrix, size, &reduceCost);
-    cost = reduceCost;
-    if (parent != NULL) {
-        cost += parent->matrix[parent->position][position] + parent->cost;
+void SearchWorker::expand(CityNode *node, vector<CityNode *> &children, Deadline &deadline) {
+    COUNT(BNB_NODES_EXPANDED, 1);
+    for (int i = 0; i < (int) node->notUsed.size() && !deadline.expired(); i++) {
+        CityNode *child = createChild(node, i, deadline);
+        if (child->cost < upper) {
+            children.push_back(child);
+        } else {
+            pool.release(child);
+        }
     }
+    sort(children.begin(), children.end(), NodeOrder());
 }
 
 /**
- * Sets parent row to infinity and column of the node to infinity
+ * Creates worker for every thread of the search.
+ * @param distanceMatrix Distance matrix between cities
+ * @param size Number of cities
+ * @param workerCount Number of workers
  */
-void CityNode::rowColumnInfinity() {
-    rowInfinity(this->matrix, this->parent->position, size);
-    columnInfinity(this->matrix, this->position, size);
+BranchAndBound::BranchAndBound(int **distanceMatrix, int size, int workerCount)
+        : distanceMatrix(distanceMatrix), size(size), upper(INT_MAX), open(0) {
+    for (int i = 0; i < workerCount; i++) {
+        workers.emplace_back(new SearchWorker(distanceMatrix, size));
+    }
 }
 
 /**
- * Selects next solution candidate for changing the upper bound and finding the solution to the problem.
- * @return Solution found after iteration
+ * Replaces the incumbent with tour found by worker if it is shorter, and updates worker's view of the incumbent.
+ * @param worker Worker with possibly found tour
  */
-CityNode* CityNode::iterate() {
-    if (notUsed.empty()) return this;
-
-    if (children.empty()) {
-        branch();
-    }
-
-    if (!children.empty() && children[0]->notUsed.empty()) {
-        return getBestChild();
+void BranchAndBound::publish(SearchWorker &worker) {
+    if (!worker.found.empty()) {
+        int length = calculateTourDistance(worker.found, distanceMatrix);
+        lock_guard<mutex> guard(incumbentLock);
+        if (length < upper.load()) {
+            incumbent = worker.found;
+            upper.store(length);
+        }
+        worker.found.clear();
     }
-    return pickNext()->iterate();
+    worker.upper = upper.load();
 }
 
 /**
- * Gets the best child with lowest cost from a node
- * @return lowest cost child
+ * Takes node for worker, deepest one from its own deque, or shallowest one from deque of another worker.
+ * @param index Index of the worker
+ * @return Node, or null if all deques are empty
  */
-CityNode* CityNode::getBestChild() {
-    CityNode* best = children[0];
-    for (int i = 1, s = children.size(); i < s; i++) {
-        if (children[i]->cost < best->cost) {
-            best = children[i];
+CityNode *BranchAndBound::take(int index) {
+    for (int k = 0; k < (int) workers.size(); k++) {
+        SearchWorker &victim = *workers[(index + k) % workers.size()];
+        lock_guard<mutex> guard(victim.lock);
+        if (victim.nodes.empty()) continue;
+        CityNode *node;
+        if (k == 0) {
+            node = victim.nodes.back();
+            victim.nodes.pop_back();
+        } else {
+            node = victim.nodes.front();
+            victim.nodes.pop_front();
         }
+        return node;
     }
-    return best;
+    return nullptr;
 }
 
 /**
- * Sets the positions from parents to node to infinity.
+ * Searches subtree of a node depth-first without adding nodes to any frontier. Every frame keeps only bounds and
+ * positions of children that can improve the incumbent, children are bounded again from node's penalties when search
+ * descends into them, so memory depends on depth of the tree and not on its size.
+ * @param worker Worker running the search
+ * @param node Root of the subtree
+ * @param deadline Time budget of the search
  */
-void CityNode::setParentInfinity() {
-    CityNode* temp = parent;
-    while (temp != NULL) {
-        matrix[position][temp->position] = INT_MAX;
-        temp = temp->parent;
+void BranchAndBound::dive(SearchWorker &worker, CityNode *node, Deadline &deadline) {
+    vector<pair<int, int>> order;
+    for (int i = 0; i < (int) node->notUsed.size() && !deadline.expired(); i++) {
+        CityNode *child = worker.createChild(node, i, deadline);
+        publish(worker);
+        if (child->cost < worker.upper) order.emplace_back(child->cost, i);
+        worker.pool.release(child);
+    }
+    sort(order.begin(), order.end());
+    for (const pair<int, int> &next : order) {
+        if (next.first >= worker.upper || deadline.expired()) break;
+        CityNode *child = worker.createChild(node, next.second, deadline);
+        publish(worker);
+        if (child->cost < worker.upper) dive(worker, child, deadline);
+        worker.pool.release(child);
     }
 }
 
 /**
- * Reconstructs the TSP tour from a node by going backtracking.
- * @return TSP tour
+ * Loop of one worker of parallel search, runs until no node is left anywhere or the deadline expires. Once nodes of
+ * the worker exceed its share of the memory budget, it searches subtrees of taken nodes depth-first instead of
+ * pushing their children.
+ * @param index Index of the worker
+ * @param deadline Time budget of the search
  */
-vector<int> CityNode::reconstructPath() {
-    vector<int> path;
-    CityNode *temp = this;
-    while (temp != NULL) {
-        path.push_back(temp->position);
-        temp = temp->parent;
+void BranchAndBound::runWorker(int index, Deadline &deadline) {
+    TRACE_SCOPE("bnb_worker");
+    SearchWorker &worker = *workers[index];
+    vector<CityNode *> children;
+    while (open.load() > 0 && !deadline.expired()) {
+        CityNode *node = take(index);
+        if (node == nullptr) {
+            this_thread::yield();
+            continue;
+        }
+        worker.upper = upper.load();
+        if (node->cost < worker.upper && worker.pool.bytesUsed() > FRONTIER_MEMORY / workers.size()) {
+            dive(worker, node, deadline);
+        } else if (node->cost < worker.upper) {
+            worker.expand(node, children, deadline);
+            publish(worker);
+            open += (long) children.size();
+            lock_guard<mutex> guard(worker.lock);
+            for (CityNode *child : children) {
+                worker.nodes.push_back(child);
+            }
+        }
+        children.clear();
+        worker.pool.release(node);
+        open--;
     }
-    return path;
 }
 
 /**
- * Removes all the solutions that have a higher bound than the upper variable (global).
- * @param solution The solution not to be erased.
+ * Expands the top of the tree best-first until every worker can get several nodes, deals them out and runs workers
+ * on the shared thread pool.
+ * @param root Root node
+ * @param deadline Time budget of the search
  */
-void boundRemoval(CityNode *solution) {
-    auto it = leafs.begin();
-    while (it != leafs.end()) {
-        // Remove elements while iterating
-        if ((*it) != solution && (*it)->cost >= upper) {
-            it = leafs.erase(it);
-        } else
-            it++;
+void BranchAndBound::searchParallel(CityNode *root, Deadline &deadline) {
+    SearchWorker &first = *workers[0];
+    priority_queue<CityNode *, vector<CityNode *>, NodeOrder> frontier;
+    frontier.push(root);
+    vector<CityNode *> children;
+    while (!frontier.empty() && (int) frontier.size() < SEED_NODES * (int) workers.size() && !deadline.expired()) {
+        CityNode *node = frontier.top();
+        frontier.pop();
+        if (node->cost < upper.load()) {
+            first.expand(node, children, deadline);
+            publish(first);
+            for (CityNode *child : children) {
+                frontier.push(child);
+            }
+            children.clear();
+        }
+        first.pool.release(node);
+    }
+
+    for (int i = 0; !frontier.empty(); i++) {
+        workers[i % workers.size()]->nodes.push_front(frontier.top());
+        frontier.pop();
+        open++;
+    }
+    sharedThreadPool().parallelFor((int) workers.size(), [&](int index, int) {
+        runWorker(index, deadline);
+    });
+    for (unique_ptr<SearchWorker> &worker : workers) {
+        for (CityNode *node : worker->nodes) {
+            worker->pool.release(node);
+        }
+        worker->nodes.clear();
     }
 }
 
 /**
- * Picks next possible candidate for branching into a solution, from the leafs array.
- * @return Next city node candidate to iterate and branch to.
+ * Expands best-first in rounds. Every round takes fixed number of best nodes and expands them in parallel against the
+ * incumbent from the start of the round, then merges found tours and children in frontier order. When frontier nodes
+ * counted in the merge exceed the memory budget, subtrees of remaining frontier nodes are searched depth-first one by
+ * one in frontier order. Memory held by pools of workers depends on scheduling, so it does not decide the switch.
+ * @param root Root node
+ * @param deadline Time budget of the search
  */
-CityNode* pickNext() {
-    CityNode *solution = NULL;
-    auto it = leafs.begin();
-
-    while (it != leafs.end()) {
-        if (solution == NULL) {
-            if (!(*it)->notUsed.empty()) {
-                solution = *it;
+void BranchAndBound::searchDeterministic(CityNode *root, Deadline &deadline) {
+    priority_queue<CityNode *, vector<CityNode *>, NodeOrder> frontier;
+    frontier.push(root);
+    vector<CityNode *> batch;
+    vector<vector<CityNode *>> children(DETERMINISTIC_BATCH);
+    vector<vector<int>> found(DETERMINISTIC_BATCH);
+    size_t nodeBytes = workers[0]->pool.nodeBytes();
+    size_t frontierBytes = nodeBytes;
+    while (!frontier.empty() && !deadline.expired() && frontierBytes <= FRONTIER_MEMORY) {
+        while (!frontier.empty() && (int) batch.size() < DETERMINISTIC_BATCH) {
+            CityNode *node = frontier.top();
+            frontier.pop();
+            if (node->cost < upper.load()) {
+                batch.push_back(node);
+            } else {
+                workers[0]->pool.release(node);
             }
-        } else if (solution->cost > (*it)->cost && !(*it)->notUsed.empty()) {
-            solution = *it;
         }
-        it++;
+        int roundUpper = upper.load();
+        sharedThreadPool().parallelFor((int) batch.size(), [&](int i, int index) {
+            TRACE_SCOPE("bnb_expand");
+            SearchWorker &worker = *workers[index];
+            worker.upper = roundUpper;
+            worker.expand(batch[i], children[i], deadline);
+            found[i].swap(worker.found);
+            worker.found.clear();
+        });
+
+        for (int i = 0; i < (int) batch.size(); i++) {
+            SearchWorker &worker = *workers[i % workers.size()];
+            worker.found.swap(found[i]);
+            publish(worker);
+            found[i].clear();
+        }
+        for (int i = 0; i < (int) batch.size(); i++) {
+            SearchWorker &worker = *workers[i % workers.size()];
+            for (CityNode *child : children[i]) {
+                if (child->cost < upper.load()) {
+                    frontier.push(child);
+                } else {
+                    worker.pool.release(child);
+                }
+            }
+            children[i].clear();
+            worker.pool.release(batch[i]);
+        }
+        batch.clear();
+        frontierBytes = frontier.size() * nodeBytes;
     }
+    while (!frontier.empty()) {
+        CityNode *node = frontier.top();
+        frontier.pop();
+        if (node->cost < upper.load() && !deadline.expired()) dive(*workers[0], node, deadline);
+        workers[0]->pool.release(node);
+    }
+}
 
-    if (solution != NULL) {
-        return solution;
+/**
+ * Runs the search. It ends when no node is left, proving the incumbent optimal, or when the deadline expires.
+ * Christofides tour improved by 2-opt is the first incumbent.
+ * @param deadline Time budget of the search
+ * @param deterministic True for search whose result does not depend on threads
+ * @return Best tour found
+ */
+vector<int> BranchAndBound::solve(Deadline &deadline, bool deterministic) {
+    TRACE_SCOPE("bnb_search");
+    SearchWorker &first = *workers[0];
+    first.improve(opt2Algorithm(christofidesAlgorithm(distanceMatrix, size), distanceMatrix, size, deadline));
+    publish(first);
+    CityNode *root = first.createRoot(deadline);
+    publish(first);
+    if (root->cost >= upper.load()) {
+        first.pool.release(root);
+    } else if (deterministic) {
+        searchDeterministic(root, deadline);
+    } else {
+        searchParallel(root, deadline);
     }
-    return leafs.front();
+    return incumbent;
+}
+
+/**
+ * @return True if TSP_DETERMINISTIC environment variable is set to non-zero value
+ */
+bool deterministicSearch() {
+    const char *deterministic = getenv("TSP_DETERMINISTIC");
+    return deterministic != nullptr && atoi(deterministic) != 0;
 }
 
 /**
- * Starts the branch and bound algorithm, by beginning with a random node, branching itself until it finds a solution. The cost of
- * solution updates the upper bound and every node that had a higher cost than the upper bound is therefore deleted. Process is repeated until
- * the solution with the optimal cost is selected
+ * Starts the branch and bound algorithm from city 0, in deterministic mode if TSP_DETERMINISTIC environment variable
+ * is set.
  * @param distanceMatrix Distance matrix between cities.
  * @param size Size of the distance matrix
+ * @param deadline Time budget of the algorithm
  * @return Optimal tsp tour.
  */
-vector<int> branchNBound(int **distanceMatrix, int size) {
-    int cost = 0;
-    int **costMatrix = createCostMatrix(distanceMatrix, size);
-    int **reducedMatrix = reduceMatrix(costMatrix, size, &cost);
-
-    vector<int> notUsed = fillVector(size);
-    int number = notUsed[0];
-    notUsed.erase(notUsed.begin());
-    shuffle(notUsed.begin(), notUsed.end(), std::mt19937(std::random_device()()));
-    CityNode root = CityNode(notUsed, reducedMatrix, cost, size, number);
-    leafs.push_front(&root);
-
-    CityNode *node = &root;
-    CityNode *solution = NULL;
-    while (true) {
-        solution = node->iterate();
-        int bound = solution->cost;
-        if (bound > upper) {
-            leafs.remove(solution);
-        } else {
-            upper = bound;
-            boundRemoval(solution);
-        }
-        if (leafs.size() == 1 && (*leafs.begin())->notUsed.empty()) {
-            break;
-        }
-        node = pickNext();
-        if (node->notUsed.empty()) {
-            solution = node;
-            break;
-        }
-    }
-
+vector<int> branchNBound(int **distanceMatrix, int size, Deadline &deadline) {
+    return branchNBound(distanceMatrix, size, deadline, deterministicSearch());
+}
 
-    return solution->reconstructPath();
-}
\ No newline at end of file
+/**
+ * Starts the branch and bound algorithm from city 0, expanding partial tours on all threads until the optimal tour is
+ * proven. If deadline expires, best complete solution found so far is returned, which is at least as good as
+ * Christofides tour improved by 2-opt. Small instances are solved by Held-Karp dynamic programming instead.
+ * @param distanceMatrix Distance matrix between cities.
+ * @param size Size of the distance matrix
+ * @param deadline Time budget of the algorithm
+ * @param deterministic True for search whose result does not depend on number of threads or their timing, as long as
+ * it is not stopped by the deadline
+ * @return Optimal tsp tour.
+ */
+vector<int> branchNBound(int **distanceMatrix, int size, Deadline &deadline, bool deterministic) {
+    if (size <= 3) {
+        vector<int> tour;
+        for (int i = 0; i < size; i++) tour.push_back(i);
+        return tour;
+    }
+    PHASE_TIMER(BNB_TIMER);
+    if (size <= HELD_KARP_CITIES && heldKarpFeasible(size)) {
+        vector<int> tour = heldKarp(distanceMatrix, size, deadline);
+        if (!tour.empty()) return tour;
+    }
+    BranchAndBound search(distanceMatrix, size, sharedThreadPool().size());
+    return search.solve(deadline, deterministic);
+}
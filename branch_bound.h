@@ -1,77 +1,166 @@
 #ifndef TSP_FINAL_BRANCH_BOUND_H
 #define TSP_FINAL_BRANCH_BOUND_H
 
-#include <random>
-#include <iostream>
-#include <sstream>
-#include <fstream>
 #include <vector>
-#include <iterator>
-#include <math.h>
-#include <random>
-#include <algorithm>
+#include <queue>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
 #include <climits>
-#include <list>
-#include <vector>
+#include "deadline.h"
+#include "arena.h"
 
 using namespace std;
 
-void rowInfinity(int **matrix, int position, int size);
-void columnInfinity(int **matrix, int position, int size);
-int **copyMatrix(int **old, int size);
-int **createCostMatrix(int **distanceMatrix, int size);
-int **reduceMatrix(int **matrix, int size, int *cost);
-vector<int> branchNBound(int **distanceMatrix, int size);
+bool deterministicSearch();
+vector<int> branchNBound(int **distanceMatrix, int size, Deadline &deadline);
+vector<int> branchNBound(int **distanceMatrix, int size, Deadline &deadline, bool deterministic);
 
+/**
+ * Node of the search tree, partial tour starting at city 0 with its Lagrangian node penalties and lower bound.
+ */
 class CityNode {
 public:
-    CityNode *parent = NULL;
-    vector<CityNode *> children;
+    /** Visited cities in order, last one is current position. */
+    vector<int> path;
     vector<int> notUsed;
-    int **matrix;
-    int cost;
+    /** Penalty of every city, only unused cities are meaningful, children start from parent's penalties. */
+    double *penalties = nullptr;
+    /** Length of the partial tour. */
+    int length = 0;
+    /** Lower bound of every tour completing the partial tour. */
+    int cost = 0;
+
+    int position() const { return path.back(); }
+};
+
+/**
+ * Orders frontier by lower bound, deeper node first among equal bounds so complete tours are reached sooner. Paths
+ * break remaining ties, so the order does not depend on the order nodes were created in.
+ */
+struct NodeOrder {
+    bool operator()(const CityNode *a, const CityNode *b) const {
+        if (a->cost != b->cost) return a->cost > b->cost;
+        if (a->path.size() != b->path.size()) return a->path.size() < b->path.size();
+        return a->path > b->path;
+    }
+};
+
+/**
+ * Recycles nodes of one search. Penalty arrays are allocated from arena and nodes keep them when released, so pruned
+ * nodes give their memory to new ones and peak memory follows the frontier size.
+ */
+class NodePool {
+public:
+    explicit NodePool(int size) : size(size) {};
+
+    NodePool(const NodePool &) = delete;
+
+    NodePool &operator=(const NodePool &) = delete;
+
+    ~NodePool();
+
+    CityNode *acquire();
+
+    void release(CityNode *node);
+
+    size_t bytesUsed() const;
+
+    size_t nodeBytes() const;
+
+private:
     int size;
-    int position;
-    int depth;
+    Arena arena;
+    vector<CityNode *> nodes;
+    vector<CityNode *> released;
+};
 
-    CityNode(CityNode *parent, vector<int> notUsed, int **matrix, int cost, int size, int position) : notUsed(notUsed),
-                                                                                                      matrix(matrix),
-                                                                                                      cost(cost),
-                                                                                                      size(size),
-                                                                                                      position(
-                                                                                                              position) {
-        this->parent = parent;
-        this->depth = this->parent->depth + 1;
-    };
+/**
+ * Bounds and expands nodes for one thread of the search. Owns scratch memory of 1-tree computation, pool of its nodes
+ * and deque of nodes waiting for expansion, which other workers steal from when idle.
+ */
+class SearchWorker {
+public:
+    int **distanceMatrix;
+    int size;
+    NodePool pool;
+    /** Nodes waiting for expansion, owner takes from the back, thieves from the front. */
+    deque<CityNode *> nodes;
+    mutex lock;
+    /** Incumbent length known to the worker, children are bounded against it. */
+    int upper = INT_MAX;
+    /** Shortest tour found since it was last collected, empty if none. */
+    vector<int> found;
 
-    CityNode(vector<int> notUsed, int **matrix, int cost, int size, int position) {
-        this->notUsed = notUsed;
-        this->matrix = matrix;
-        this->cost = cost;
-        this->size = size;
-        this->position = position;
-        this->depth = 0;
-    };
+    SearchWorker(int **distanceMatrix, int size);
 
-    bool isLeaf();
+    CityNode *createRoot(Deadline &deadline);
 
-    void branch();
+    CityNode *createChild(CityNode *parent, int index, Deadline &deadline);
 
-    void getCost();
+    void expand(CityNode *node, vector<CityNode *> &children, Deadline &deadline);
 
-    void rowColumnInfinity();
+    void bound(CityNode *node, int iterations, double step, Deadline &deadline);
 
-    CityNode *iterate();
+    double oneTree(CityNode *node);
 
-    CityNode *getBestChild();
+    vector<int> treeTour(CityNode *node);
 
-    void setParentInfinity();
+    void improve(const vector<int> &tour);
 
-    vector<int> reconstructPath();
+private:
+    /** Degree of every city in the last 1-tree. */
+    vector<int> degree;
+    /** Parent of every unused city in the last spanning tree, -1 for its root. */
+    vector<int> treeParent;
+    /** Unused cities connected to current position and to city 0 in the last 1-tree. */
+    int ends[2];
+    vector<double> key;
+    vector<int> link;
+    vector<double> bestPenalties;
 };
 
-void boundRemoval(CityNode *solution);
-CityNode* pickNext();
+/**
+ * Branch and bound over partial tours. Unused cities of a node must form a path from its position back to city 0,
+ * which is bounded from below by a minimum 1-tree: spanning tree of unused cities plus cheapest edges to both ends of
+ * the partial tour. Bound is tightened with Held-Karp penalties found by subgradient optimization, which start from
+ * the parent's penalties.
+ *
+ * Parallel search expands the top of the tree best-first and deals the frontier out to workers, which continue
+ * depth-first from their deques, steal when idle and share the incumbent through an atomic. Deterministic search
+ * expands best-first in rounds of fixed size, bounding every round against the same incumbent and merging results in
+ * frontier order, so the tour does not depend on the number of threads or their timing. Both switch to depth-first
+ * search of subtrees without frontier when nodes exceed memory budget.
+ */
+class BranchAndBound {
+public:
+    int **distanceMatrix;
+    int size;
+    atomic<int> upper;
+    vector<int> incumbent;
+    vector<unique_ptr<SearchWorker>> workers;
+
+    BranchAndBound(int **distanceMatrix, int size, int workerCount);
+
+    vector<int> solve(Deadline &deadline, bool deterministic);
 
+    void publish(SearchWorker &worker);
+
+private:
+    void searchParallel(CityNode *root, Deadline &deadline);
+
+    void searchDeterministic(CityNode *root, Deadline &deadline);
+
+    void runWorker(int index, Deadline &deadline);
+
+    void dive(SearchWorker &worker, CityNode *node, Deadline &deadline);
+
+    CityNode *take(int index);
+
+    mutex incumbentLock;
+    /** Nodes in deques or being expanded, search is over when it drops to zero. */
+    atomic<long> open;
+};
 
-#endif //TSP_FINAL_ANT_COLONY_OPTIMIZATION_H
+#endif //TSP_FINAL_BRANCH_BOUND_H
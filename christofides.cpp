@@ -2,9 +2,20 @@
 #include <vector>
 #include <random>
 #include <algorithm>
+#include <climits>
+#include "christofides.h"
+#include "kd_tree.h"
+#include "opt2local.h"
+#include "random_provider.h"
+#include "thread_pool.h"
+#include "counters.h"
+#include "trace.h"
 
 using namespace std;
 
+/** Number of nearest neighbors of every city in candidate graph used for spanning tree */
+const int MST_CANDIDATES = 10;
+
 /**
  * Function for obtaining index of minimum cut between unused vertices and currently selected index.
  *
@@ -16,7 +27,7 @@ using namespace std;
 int minimumIndex(const int mins[], const int used[], int size) {
     int minIndex = -1;
     for (int i = 0; i < size; ++i) {
-        if (!used[i] && (mins[i] < mins[minIndex] || minIndex == -1)) {
+        if (!used[i] && (minIndex == -1 || mins[i] < mins[minIndex])) {
             minIndex = i;
         }
     }
@@ -25,34 +36,33 @@ int minimumIndex(const int mins[], const int used[], int size) {
 
 /**
  * Prim's algorithm for finding minimum spanning tree. Finding a cut in every step of algorithm to connect vertices
- * already included in MST and those who are not. That guarantees creating a minimum spanning tree.
+ * already included in MST and those who are not. That guarantees creating a minimum spanning tree. Runs in O(n^2)
+ * which is optimal when every distance has to be inspected, as for explicit distance matrix.
  *
  * @param mst Vector of edges defining minimum spanning tree
- * @param dist Matrix of distances between vertices
+ * @param distances Distances between vertices
  * @param size Size of TSP problem
  */
-void minimumSpanningTree(vector<pair<int, int>> &mst, int **dist, int size) {
+void denseSpanningTree(vector<pair<int, int>> &mst, const Distances &distances, int size) {
     // Distances from current vertex and ones to be included in MST
-    int mins[size];
+    vector<int> mins(static_cast<unsigned long>(size), INT32_MAX);
     // Array for defining if vertex is used in MST
-    int used[size] = {0};
+    vector<int> used(static_cast<unsigned long>(size), 0);
     // Array corresponding to joined vertices
-    int edge[size] = {0};
+    vector<int> edge(static_cast<unsigned long>(size), 0);
 
-    for (int i = 0; i < size; ++i) {
-        if (i != 0) mins[i] = INT32_MAX;
-        else mins[i] = 0;
-    }
+    mins[0] = 0;
     for (int i = 0; i < size - 1; ++i) {
         // Finding current minimum index, closest disjoint edge
-        int index = minimumIndex(mins, used, size);
+        int index = minimumIndex(mins.data(), used.data(), size);
         used[index] = 1;
         for (int j = 0; j < size; ++j) {
-            if (j == index) continue;
+            if (j == index || used[j]) continue;
             // Setting new values for vertices not yet included in MST
-            if (!used[j] && dist[index][j] < mins[j]) {
+            int distance = distances(index, j);
+            if (distance < mins[j]) {
                 edge[j] = index;
-                mins[j] = dist[index][j];
+                mins[j] = distance;
             }
         }
     }
@@ -62,18 +72,93 @@ void minimumSpanningTree(vector<pair<int, int>> &mst, int **dist, int size) {
     }
 }
 
+/**
+ * Kruskal's algorithm on sparse candidate graph connecting every city with its nearest neighbors, found with k-d tree.
+ * Components left disconnected by candidate graph are joined with Boruvka steps, where every component is connected
+ * to its closest city outside of it. Runs in O(n log n) for cities in the plane, result is minimum spanning tree of
+ * candidate graph, which in practice matches euclidean one.
+ *
+ * @param mst Vector of edges defining spanning tree
+ * @param distances Distances between vertices, coordinates are required
+ * @param size Size of TSP problem
+ */
+void sparseSpanningTree(vector<pair<int, int>> &mst, const Distances &distances, int size) {
+    KdTree tree(*distances.vertices);
+
+    // Candidate edges as (distance, (from, to)), each undirected edge once
+    vector<pair<int, pair<int, int>>> edges;
+    edges.reserve(static_cast<unsigned long>(size) * MST_CANDIDATES);
+    vector<vector<int>> neighbors = tree.allNearest(MST_CANDIDATES);
+    for (int i = 0; i < size; ++i) {
+        for (int j : neighbors[i]) {
+            edges.push_back(make_pair(distances(i, j), make_pair(min(i, j), max(i, j))));
+        }
+    }
+    sort(edges.begin(), edges.end());
+    edges.erase(unique(edges.begin(), edges.end()), edges.end());
+
+    DisjointSet components(size);
+    for (auto &e : edges) {
+        if (components.unite(e.second.first, e.second.second)) {
+            mst.push_back(e.second);
+        }
+    }
+
+    vector<int> labels(static_cast<unsigned long>(size));
+    while ((int) mst.size() < size - 1) {
+        for (int i = 0; i < size; ++i) {
+            labels[i] = components.find(i);
+        }
+        tree.updateLabels(labels);
+
+        // Closest outgoing edge of every component, indexed by its representative
+        vector<pair<int, pair<int, int>>> closest(static_cast<unsigned long>(size), make_pair(INT_MAX, make_pair(-1, -1)));
+        for (int i = 0; i < size; ++i) {
+            int j = tree.nearestOutside(i, labels);
+            int distance = distances(i, j);
+            if (distance < closest[labels[i]].first) {
+                closest[labels[i]] = make_pair(distance, make_pair(i, j));
+            }
+        }
+        for (int i = 0; i < size; ++i) {
+            if (labels[i] != i) continue;
+            pair<int, int> e = closest[i].second;
+            if (components.unite(e.first, e.second)) {
+                mst.push_back(e);
+            }
+        }
+    }
+}
+
+/**
+ * Finds minimum spanning tree, on sparse candidate graph when coordinates of cities are known and with Prim's dense
+ * algorithm for explicit distance matrix.
+ *
+ * @param mst Vector of edges defining minimum spanning tree
+ * @param distances Distances between vertices
+ * @param size Size of TSP problem
+ */
+void minimumSpanningTree(vector<pair<int, int>> &mst, const Distances &distances, int size) {
+    TRACE_SCOPE("spanning_tree");
+    if (distances.hasCoordinates()) {
+        sparseSpanningTree(mst, distances, size);
+    } else {
+        denseSpanningTree(mst, distances, size);
+    }
+}
+
 
 /**
  *  Greedy algorithm adapted for finding TSP tour through edges that have odd number of connected edges.
  *
  * @param graph Vertices with odd number of edges
- * @param distanceMatrix Matrix defining distances in graph
+ * @param distances Distances between vertices
  * @return Greedy route through vertices with odd number of edges
  */
-vector<int> greedyTourMatching(vector<int> graph, int **distanceMatrix) {
+vector<int> greedyTourMatching(vector<int> graph, const Distances &distances) {
     vector<int> tour;
     int size = (int) graph.size();
-    int used[size] = {0};
+    vector<int> used(static_cast<unsigned long>(size), 0);
     tour.push_back(graph[0]);
 
     // Greedy algorithm adapted for tour matching
@@ -82,7 +167,7 @@ vector<int> greedyTourMatching(vector<int> graph, int **distanceMatrix) {
         int best = -1;
         int bestInd = -1;
         for (int j = 0; j < size; j++) {
-            if (!used[j] && (best == -1 || distanceMatrix[tour[i - 1]][graph[j]] < distanceMatrix[tour[i - 1]][best])) {
+            if (!used[j] && (best == -1 || distances(tour[i - 1], graph[j]) < distances(tour[i - 1], best))) {
                 best = graph[j];
                 bestInd = j;
             }
@@ -100,12 +185,12 @@ vector<int> greedyTourMatching(vector<int> graph, int **distanceMatrix) {
  *  connected to create even number of edges in each vertex, since that is prerequisite for Euler graph.
  *
  * @param mst Provided minimum spanning tree
- * @param distanceMatrix Matrix defining distances in graph
+ * @param distances Distances between vertices
  * @param size Size of TSP problem
  */
-void greedyMinWeightMatching(vector<pair<int, int>> &mst, int **distanceMatrix, int size) {
+void greedyMinWeightMatching(vector<pair<int, int>> &mst, const Distances &distances, int size) {
     // Calculation of vertices degree
-    int histogram[size] = {0};
+    vector<int> histogram(static_cast<unsigned long>(size), 0);
     for (pair<int, int> e : mst) {
         histogram[e.first]++;
         histogram[e.second]++;
@@ -119,8 +204,8 @@ void greedyMinWeightMatching(vector<pair<int, int>> &mst, int **distanceMatrix,
     }
 
     // Shuffling tour for get different starting position (since greedy alg is sensible to starting position)
-    shuffle(oddTour.begin(), oddTour.end(), std::mt19937(std::random_device()()));
-    vector<int> match = greedyTourMatching(oddTour, distanceMatrix);
+    shuffle(oddTour.begin(), oddTour.end(), std::mt19937(nextSeed()));
+    vector<int> match = greedyTourMatching(oddTour, distances);
 
     // Collecting pairs in TSP tour obtained with greedy algorithm
     for (int j = 1; j < match.size(); j += 2) {
@@ -129,154 +214,232 @@ void greedyMinWeightMatching(vector<pair<int, int>> &mst, int **distanceMatrix,
 }
 
 /**
- * With edges that define minimum spanning tree, first step is creation of euler graph, with every vertex to
- * have even degree. Array provided in function defines vertices of Euler graph. Function then finds cycles of vertices
- * provided as input. That task can always be done when euler's graph is given.
+ * Matching vertices with odd degree in minimum spanning tree, so every vertex of obtained graph has even degree.
  *
- * @param mst Minimum spanning tree with tour matching
- * @param distanceMatrix Matrix defining distances in graph
+ * @param mst Provided minimum spanning tree, matched pairs are added to it
+ * @param distances Distances between vertices
  * @param size Size of TSP problem
- * @return Cycles which should be connected
+ * @param mode Matching strategy
  */
-vector<vector<int>> eulerCycles(vector<pair<int, int>> mst, int **distanceMatrix, int size) {
-    // Keeping track of visited vertices
-    int visited[size] = {0};
-    for (pair<int, int> e : mst) {
-        visited[e.first]++;
-        visited[e.second]++;
-    }
-    int searching = mst[0].first;
-
-    vector<vector<int>> cycles;
-    vector<int> vertices;
-    for (int i = 0, n = (int) mst.size(); i < n; ++i) {
-
-        //Creating one cycle
-        int index = -1;
-        vertices.push_back(searching);
-
-        for (int j = 0; j < mst.size(); ++j) {
-            // After matching search for second vertex in pair
-            if (mst[j].first == searching) {
-                index = j;
-                searching = mst[j].second;
-                break;
-            } else if (mst[j].second == searching) {
-                index = j;
-                searching = mst[j].first;
-                break;
-            }
-        }
-        if (index == -1) {
-            // After closing cycle, add vertices
-            cycles.push_back(vertices);
-            vertices.clear();
-
-            for (int k = 0; k < size; k++) {
-                if (visited[k] == 2) {
-                    // Next cycle starts at unvisited
-                    searching = k;
-                    break;
-                }
-            }
-            --i;
-            continue;
-        }
-
-        // Show visited indexes and delete visited edge
-        visited[mst[index].first]--;
-        visited[mst[index].second]--;
-        mst.erase(mst.begin() + index);
+void minWeightMatching(vector<pair<int, int>> &mst, const Distances &distances, int size, MatchingMode mode) {
+    TRACE_SCOPE("matching");
+    if (mode == TOUR_MATCHING) {
+        greedyMinWeightMatching(mst, distances, size);
+        return;
     }
-    cycles.push_back(vertices);
-
-    return cycles;
+    vector<int> odd = oddDegreeVertices(mst, size);
+    bool exact = mode == EXACT_MATCHING || (mode == AUTO_MATCHING && exactMatchingFeasible((int) odd.size()));
+    vector<pair<int, int>> matching = exact ? exactMatching(odd, distances) : greedyEdgeMatching(odd, distances);
+    mst.insert(mst.end(), matching.begin(), matching.end());
 }
 
 /**
- * Function for checking if value is contained in vector. If that is the case, index of value is returned, -1 otherwise.
+ * Hierholzer's algorithm for finding Euler circuit in graph where every vertex has even degree, which is guaranteed
+ * after matching. Graph is stored as adjacency lists in compressed form and every edge is traversed exactly once, so
+ * circuit is obtained in O(E) in one pass.
  *
- * @param v Vector to search in
- * @param s Value that should be found
- * @return Index of value if contains, -1 otherwises
+ * @param edges Minimum spanning tree with tour matching, parallel edges allowed
+ * @param size Size of TSP problem
+ * @return Euler circuit as sequence of vertices, first vertex is not repeated at the end
  */
-int containsIndex(vector<int> v, int s) {
-    for (int i = 0, n = v.size(); i < n; ++i) {
-        if (s == v[i]) return i;
+vector<int> eulerTour(const vector<pair<int, int>> &edges, int size) {
+    TRACE_SCOPE("euler_tour");
+    // Adjacency lists stored one after another, list of vertex v is in [offset[v], offset[v + 1])
+    vector<int> offset(static_cast<unsigned long>(size) + 1, 0);
+    for (const pair<int, int> &e : edges) {
+        offset[e.first + 1]++;
+        offset[e.second + 1]++;
+    }
+    for (int i = 0; i < size; ++i) {
+        offset[i + 1] += offset[i];
+    }
+    vector<int> fill(offset.begin(), offset.end() - 1);
+    // Every entry is pair of neighbor and index of edge, so parallel edges stay distinct
+    vector<pair<int, int>> adjacency(static_cast<unsigned long>(offset[size]));
+    for (int i = 0, n = (int) edges.size(); i < n; ++i) {
+        adjacency[fill[edges[i].first]++] = make_pair(edges[i].second, i);
+        adjacency[fill[edges[i].second]++] = make_pair(edges[i].first, i);
+    }
+
+    vector<bool> used(edges.size(), false);
+    // Next adjacency entry to be examined for every vertex
+    vector<int> next(offset.begin(), offset.end() - 1);
+    vector<int> tour;
+    tour.reserve(edges.size() + 1);
+    vector<int> stack;
+    stack.push_back(edges.empty() ? 0 : edges[0].first);
+    while (!stack.empty()) {
+        int v = stack.back();
+        while (next[v] < offset[v + 1] && used[adjacency[next[v]].second]) {
+            next[v]++;
+        }
+        if (next[v] == offset[v + 1]) {
+            // Dead end closes a sub-cycle, which is spliced into circuit while unwinding
+            tour.push_back(v);
+            stack.pop_back();
+        } else {
+            used[adjacency[next[v]].second] = true;
+            stack.push_back(adjacency[next[v]].first);
+        }
     }
-    return -1;
+    if (tour.size() > 1) tour.pop_back();
+    return tour;
 }
 
 /**
- * Deleting created duplicates to create hamiltonian tour around graph.
+ * Deleting created duplicates to create hamiltonian tour around graph. Only first occurrence of every vertex is
+ * kept, visited vertices are tracked in bitmap so tour is processed in one pass.
  *
  * @param tour Solution in which duplicates will be removed
  */
 void deleteDuplicates(vector<int> &tour) {
-    for (int i = 0; i < tour.size(); ++i) {
-        vector<int> remove;
-        for (int j = i + 1; j < tour.size(); ++j) {
-            if (tour[i] == tour[j]) {
-                remove.push_back(j);
-            }
-        }
-        for (int j = 0; j < remove.size(); ++j) {
-            tour.erase(tour.begin() + remove[j] - j);
-        }
+    int size = tour.empty() ? 0 : *max_element(tour.begin(), tour.end()) + 1;
+    vector<bool> visited(static_cast<unsigned long>(size), false);
+    int length = 0;
+    for (int v : tour) {
+        if (visited[v]) continue;
+        visited[v] = true;
+        tour[length++] = v;
     }
+    tour.resize(static_cast<unsigned long>(length));
 }
 
 /**
- * Provided with disjoint cycles, function for connecting those cycles and creating Hamiltonian cycle around graph. This
- * task is always possible since every disjoint cycle shares one index with other cycle.
+ * Shortcutting that chooses which occurrence of repeated vertex is kept. Skipping vertex between its neighbors in
+ * the circuit saves d(prev, v) + d(v, next) - d(prev, next), so occurrence with smallest saving is kept and others
+ * are skipped. Every occurrence is evaluated once, so pass stays O(n).
  *
- * @param cycles Provided disjoint cycles
- * @param distanceMatrix Matrix defining distances in graph
+ * @param tour Euler circuit through all vertices
+ * @param distances Distances between vertices
  * @param size Size of TSP problem
  * @return Hamiltonian cycle
  */
-vector<int> hamiltonianPath(vector<vector<int>> cycles, int **distanceMatrix, int size) {
-    vector<int> tour;
-    // First euclidian cycle
-    tour.insert(tour.end(), cycles[0].begin(), cycles[0].end());
-    cycles.erase(cycles.begin());
-    for (int i = 0; i < tour.size(); ++i) {
-        int index = -1;
-        // Find cycle that contains vertex with same index
-        for (int j = 0; j < cycles.size(); ++j) {
-            index = containsIndex(cycles[j], tour[i]);
-            if (index != -1) {
-                for (int k = 1; k < cycles[j].size() + 1; ++k) {
-                    tour.insert(tour.begin() + i + k, cycles[j][(k + index) % cycles[j].size()]);
-                }
-
-                // Delete added cycle
-                cycles.erase(cycles.begin() + j);
-                break;
-            }
+vector<int> bestShortcut(const vector<int> &tour, const Distances &distances, int size) {
+    int n = (int) tour.size();
+    vector<int> keep(static_cast<unsigned long>(size), -1);
+    vector<int> bestSaving(static_cast<unsigned long>(size), INT_MAX);
+    for (int i = 0; i < n; ++i) {
+        int prev = tour[(i + n - 1) % n];
+        int v = tour[i];
+        int next = tour[(i + 1) % n];
+        int saving = distances(prev, v) + distances(v, next) - distances(prev, next);
+        if (saving < bestSaving[v]) {
+            bestSaving[v] = saving;
+            keep[v] = i;
         }
-        if (cycles.empty()) break;
     }
 
+    vector<int> path;
+    path.reserve(static_cast<unsigned long>(size));
+    for (int i = 0; i < n; ++i) {
+        if (keep[tour[i]] == i) path.push_back(tour[i]);
+    }
+    return path;
+}
 
+/**
+ * Creating Hamiltonian cycle from Euler circuit by skipping vertices that were already visited.
+ *
+ * @param tour Euler circuit through all vertices
+ * @param distances Distances between vertices
+ * @param size Size of TSP problem
+ * @param best Use best shortcut instead of keeping first occurrences
+ * @return Hamiltonian cycle
+ */
+vector<int> hamiltonianPath(vector<int> tour, const Distances &distances, int size, bool best) {
+    TRACE_SCOPE("shortcut");
+    if (best) return bestShortcut(tour, distances, size);
     deleteDuplicates(tour);
     return tour;
 }
 
 /**
- * Core of the Christofides algorithm, first MST is created using Prim's greedy method. After that, vertices with odd
- * degree are connected with greedy tour matching. Last step is, from the obtained euler's graph get disjoint cycles
- * and connect them into one Hamiltonian cylce.
+ * Core of the Christofides algorithm, first MST is created, on candidate graph when coordinates are known and with
+ * Prim's greedy method otherwise. After that, vertices with odd degree are matched with selected strategy. Last
+ * step is, from the Euler circuit of obtained euler's graph create Hamiltonian cycle by skipping repeated vertices.
  *
- * @param distanceMatrix Matrix defining distances in graph
+ * @param distances Distances between vertices
  * @param size Size of TSP problem
+ * @param matching Strategy for matching vertices with odd degree
  * @return Hamiltonian path that is output from Christofides algorithm
  */
-vector<int> christofidesAlgorithm(int **distanceMatrix, int size) {
+vector<int> christofidesAlgorithm(const Distances &distances, int size, MatchingMode matching) {
     vector<pair<int, int>> mst;
-    minimumSpanningTree(mst, distanceMatrix, size);
-    greedyMinWeightMatching(mst, distanceMatrix, size);
-    vector<vector<int>> eCycles = eulerCycles(mst, distanceMatrix, size);
+    minimumSpanningTree(mst, distances, size);
+    minWeightMatching(mst, distances, size, matching);
+    vector<int> circuit = eulerTour(mst, size);
+
+    return hamiltonianPath(circuit, distances, size, true);
+}
+
+/**
+ * Multi-start Christofides, several randomized constructions followed by Opt2 are run concurrently on shared thread
+ * pool. Spanning tree, odd vertices and their candidate partners are computed once and shared read only, every start
+ * perturbs greedy matching and order in which Euler circuit is traversed. First start is not randomized, so result is
+ * never worse than single construction. Starts not begun before deadline are skipped. Without distance matrix,
+ * neighbor list 2-opt is used in place of Opt2.
+ *
+ * @param distances Distances between vertices
+ * @param distanceMatrix Matrix used by Opt2, nullptr for large instances
+ * @param size Size of TSP problem
+ * @param starts Number of constructions
+ * @param keep Number of best distinct tours returned
+ * @param deadline Time budget of constructions
+ * @return Best tours with their distances, shortest first
+ */
+vector<pair<vector<int>, int>> multiStartChristofides(const Distances &distances, int **distanceMatrix, int size,
+                                                      int starts, int keep, Deadline &deadline) {
+    PHASE_TIMER(CONSTRUCTION_TIMER);
+    TRACE_SCOPE("christofides");
+    vector<pair<int, int>> mst;
+    minimumSpanningTree(mst, distances, size);
+    vector<int> odd = oddDegreeVertices(mst, size);
+    vector<vector<int>> neighbors = subsetNeighbors(odd, distances, MATCHING_CANDIDATES);
+
+    vector<unsigned long> seeds(static_cast<unsigned long>(starts));
+    for (unsigned long &seed : seeds) {
+        seed = nextSeed();
+    }
+    vector<pair<vector<int>, int>> tours(static_cast<unsigned long>(starts));
+    sharedThreadPool().parallelFor(starts, [&](int i, int /*worker*/) {
+        if (i > 0 && deadline.expired()) return;
+        TRACE_SCOPE("christofides_start");
+        RandomStream random(seeds[i]);
+        vector<pair<int, int>> edges = mst;
+        vector<pair<int, int>> matching;
+        {
+            TRACE_SCOPE("matching");
+            if (i == 0 && exactMatchingFeasible((int) odd.size())) {
+                matching = exactMatching(odd, distances);
+            } else {
+                matching = greedyEdgeMatching(odd, neighbors, distances, i == 0 ? nullptr : &random);
+            }
+        }
+        edges.insert(edges.end(), matching.begin(), matching.end());
+        // Euler circuit starts at first edge and follows edges in order they are given
+        for (int j = (int) edges.size() - 1; i > 0 && j > 0; --j) {
+            swap(edges[j], edges[random.iRand(0, (unsigned long) j)]);
+        }
+
+        vector<int> tour = hamiltonianPath(eulerTour(edges, size), distances, size, true);
+        if (distanceMatrix != nullptr) {
+            tour = opt2Algorithm(tour, distanceMatrix, size, deadline);
+        } else {
+            tour = opt2Neighbors(tour, distances, size, deadline);
+        }
+        tours[i] = make_pair(tour, calculateTourDistance(tour, distances));
+    });
 
-    return hamiltonianPath(eCycles, distanceMatrix, size);
+    tours.erase(remove_if(tours.begin(), tours.end(), [](const pair<vector<int>, int> &t) {
+        return t.first.empty();
+    }), tours.end());
+    sort(tours.begin(), tours.end(), [](const pair<vector<int>, int> &a, const pair<vector<int>, int> &b) {
+        return a.second < b.second;
+    });
+    // Tours of same length are most likely same tour, only one of them is kept
+    tours.erase(unique(tours.begin(), tours.end(), [](const pair<vector<int>, int> &a, const pair<vector<int>, int> &b) {
+        return a.second == b.second;
+    }), tours.end());
+    if ((int) tours.size() > keep) tours.resize(static_cast<unsigned long>(keep));
+    return tours;
 }
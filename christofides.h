@@ -5,25 +5,37 @@
 #include <vector>
 #include <random>
 #include <algorithm>
+#include "graph.h"
+#include "matching.h"
+#include "deadline.h"
 
 using namespace std;
 
 int minimumIndex(const int mins[], const int used[], int size);
 
-void minimumSpanningTree(vector<pair<int, int>> &mst, int **dist, int size);
+void denseSpanningTree(vector<pair<int, int>> &mst, const Distances &distances, int size);
 
-vector<int> greedyTourMatching(vector<int> graph, int **distanceMatrix);
+void sparseSpanningTree(vector<pair<int, int>> &mst, const Distances &distances, int size);
 
-void greedyMinWeightMatching(vector<pair<int, int>> &mst, int **distanceMatrix, int size);
+void minimumSpanningTree(vector<pair<int, int>> &mst, const Distances &distances, int size);
 
-vector<vector<int>> eulerCycles(vector<pair<int, int>> mst, int **distanceMatrix, int size);
+vector<int> greedyTourMatching(vector<int> graph, const Distances &distances);
 
-int containsIndex(vector<int> v, int s);
+void greedyMinWeightMatching(vector<pair<int, int>> &mst, const Distances &distances, int size);
+
+void minWeightMatching(vector<pair<int, int>> &mst, const Distances &distances, int size, MatchingMode mode);
+
+vector<int> eulerTour(const vector<pair<int, int>> &edges, int size);
 
 void deleteDuplicates(vector<int> &tour);
 
-vector<int> hamiltonianPath(vector<vector<int>> cycles, int **distanceMatrix, int size);
+vector<int> bestShortcut(const vector<int> &tour, const Distances &distances, int size);
+
+vector<int> hamiltonianPath(vector<int> tour, const Distances &distances, int size, bool best);
+
+vector<int> christofidesAlgorithm(const Distances &distances, int size, MatchingMode matching = AUTO_MATCHING);
 
-vector<int> christofidesAlgorithm(int **distanceMatrix, int size);
+vector<pair<vector<int>, int>> multiStartChristofides(const Distances &distances, int **distanceMatrix, int size,
+                                                      int starts, int keep, Deadline &deadline);
 
 #endif //TSP_FINAL_CHRISTOFIDES_H
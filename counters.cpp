@@ -0,0 +1,110 @@
+#include <fstream>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include "counters.h"
+
+using namespace std;
+
+/** Names of counters in log, in order of Counter */
+const char *COUNTER_NAMES[COUNTER_COUNT] = {
+        "opt2_passes", "opt2_moves_evaluated", "opt2_moves_applied", "sia_generations", "sia_clones", "sa_moves",
+        "sa_accepted", "sa_uphill_accepted", "aco_iterations", "aco_restarts", "aco_converged_restarts", "aco_steps",
+        "aco_fallbacks", "bnb_nodes_expanded"
+};
+/** Names of phase timers in log, in order of PhaseTimer */
+const char *TIMER_NAMES[TIMER_COUNT] = {
+        "read", "matrix", "construction", "local_search", "sia", "sa", "aco", "bnb"
+};
+
+/** Blocks of all threads which ever counted, kept after their threads exit so their counts are not lost */
+mutex registryMutex;
+vector<unique_ptr<CounterBlock>> registry;
+
+/**
+ * Counters of current thread, registered on first use.
+ *
+ * @return Counter block of current thread
+ */
+CounterBlock &threadCounters() {
+    thread_local CounterBlock *block = nullptr;
+    if (block == nullptr) {
+        lock_guard<mutex> lock(registryMutex);
+        registry.emplace_back(new CounterBlock());
+        block = registry.back().get();
+    }
+    return *block;
+}
+
+/**
+ * Sets all counters and timers of all threads to zero. Called before solver starts, while no other thread counts.
+ */
+void resetCounters() {
+    lock_guard<mutex> lock(registryMutex);
+    for (auto &block : registry) {
+        *block = CounterBlock();
+    }
+}
+
+/**
+ * Sums counters and timers of all threads. Called after solver returned, worker threads of the pool are idle by then
+ * and their counts are visible.
+ *
+ * @return Sum of all counter blocks
+ */
+CounterBlock aggregateCounters() {
+    lock_guard<mutex> lock(registryMutex);
+    CounterBlock total;
+    for (auto &block : registry) {
+        for (int i = 0; i < COUNTER_COUNT; i++) {
+            total.counters[i] += block->counters[i];
+        }
+        for (int i = 0; i < TIMER_COUNT; i++) {
+            total.nanoseconds[i] += block->nanoseconds[i];
+            total.calls[i] += block->calls[i];
+        }
+    }
+    return total;
+}
+
+/**
+ * Ratio of two counts, zero when there is nothing to divide.
+ */
+double counterRate(double count, double total) {
+    return total > 0 ? count / total : 0;
+}
+
+/**
+ * Writes counters next to the solution log, to /logs/<file>.counters, in form of lines:
+ *  <counter> <value>
+ *  <timer>_seconds <thread seconds> <calls>
+ *  <rate> <value>
+ * Nothing is written when counters are not compiled in.
+ *
+ * @param file Name of solution log without extension
+ * @param runningTime Running time of algorithm in seconds
+ */
+void logCounters(const string &file, double runningTime) {
+#ifdef TSP_COUNTERS
+    CounterBlock total = aggregateCounters();
+    const long *c = total.counters;
+    ofstream f("./logs/" + file + ".counters");
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        f << COUNTER_NAMES[i] << " " << c[i] << endl;
+    }
+    for (int i = 0; i < TIMER_COUNT; i++) {
+        if (total.calls[i] == 0) continue;
+        f << TIMER_NAMES[i] << "_seconds " << total.nanoseconds[i] / 1e9 << " " << total.calls[i] << endl;
+    }
+    f << "opt2_applied_rate " << counterRate(c[OPT2_MOVES_APPLIED], c[OPT2_MOVES_EVALUATED]) << endl;
+    f << "sia_generations_per_second " << counterRate(c[SIA_GENERATIONS], runningTime) << endl;
+    f << "sa_acceptance_rate " << counterRate(c[SA_ACCEPTED], c[SA_MOVES]) << endl;
+    f << "sa_uphill_acceptance_rate " << counterRate(c[SA_UPHILL_ACCEPTED], c[SA_MOVES]) << endl;
+    f << "aco_iterations_per_second " << counterRate(c[ACO_ITERATIONS], runningTime) << endl;
+    f << "aco_converged_restart_rate " << counterRate(c[ACO_CONVERGED_RESTARTS], c[ACO_RESTARTS]) << endl;
+    f << "aco_fallback_rate " << counterRate(c[ACO_FALLBACKS], c[ACO_STEPS]) << endl;
+#else
+    (void) file;
+    (void) runningTime;
+#endif
+}
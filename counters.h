@@ -0,0 +1,97 @@
+#ifndef TSP_FINAL_COUNTERS_H
+#define TSP_FINAL_COUNTERS_H
+
+#include <string>
+#include <chrono>
+
+using namespace std;
+
+/**
+ * Performance counters of solver hot paths. Counting is compiled in only with -DTSP_COUNTERS, otherwise COUNT and
+ * PHASE_TIMER expand to nothing and solvers run without any overhead.
+ */
+enum Counter {
+    OPT2_PASSES,
+    OPT2_MOVES_EVALUATED,
+    OPT2_MOVES_APPLIED,
+    SIA_GENERATIONS,
+    SIA_CLONES,
+    SA_MOVES,
+    SA_ACCEPTED,
+    SA_UPHILL_ACCEPTED,
+    ACO_ITERATIONS,
+    ACO_RESTARTS,
+    ACO_CONVERGED_RESTARTS,
+    ACO_STEPS,
+    ACO_FALLBACKS,
+    BNB_NODES_EXPANDED,
+    COUNTER_COUNT
+};
+
+/**
+ * Phases of solvers measured by timers. Time is summed over threads and inner phases are included in outer ones,
+ * for example local search in SIA time.
+ */
+enum PhaseTimer {
+    READ_TIMER,
+    MATRIX_TIMER,
+    CONSTRUCTION_TIMER,
+    LOCAL_SEARCH_TIMER,
+    SIA_TIMER,
+    SA_TIMER,
+    ACO_TIMER,
+    BNB_TIMER,
+    TIMER_COUNT
+};
+
+/**
+ * Counters and timers of one thread. Only its own thread writes it, so counting is a plain addition.
+ */
+struct CounterBlock {
+    long counters[COUNTER_COUNT] = {};
+    long nanoseconds[TIMER_COUNT] = {};
+    long calls[TIMER_COUNT] = {};
+};
+
+CounterBlock &threadCounters();
+
+/**
+ * Adds time from its creation to its destruction to a phase timer of current thread.
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(PhaseTimer timer) : timer(timer), begin(chrono::steady_clock::now()) {}
+
+    ScopedTimer(const ScopedTimer &) = delete;
+
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    ~ScopedTimer() {
+        CounterBlock &block = threadCounters();
+        block.nanoseconds[timer] += chrono::duration_cast<chrono::nanoseconds>(
+                chrono::steady_clock::now() - begin).count();
+        block.calls[timer]++;
+    }
+
+private:
+    PhaseTimer timer;
+    chrono::steady_clock::time_point begin;
+};
+
+#ifdef TSP_COUNTERS
+#define TSP_COUNTER_JOIN(a, b) a##b
+#define TSP_COUNTER_NAME(a, b) TSP_COUNTER_JOIN(a, b)
+#define COUNT(counter, amount) (threadCounters().counters[counter] += (amount))
+#define PHASE_TIMER(timer) ScopedTimer TSP_COUNTER_NAME(phaseTimer, __LINE__)(timer)
+#else
+#define COUNT(counter, amount) ((void) 0)
+#define PHASE_TIMER(timer) ((void) 0)
+#endif
+
+void resetCounters();
+
+CounterBlock aggregateCounters();
+
+void logCounters(const string &file, double runningTime);
+
+#endif //TSP_FINAL_COUNTERS_H
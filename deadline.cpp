@@ -0,0 +1,49 @@
+#include <chrono>
+#include <limits>
+#include "deadline.h"
+
+using namespace std;
+
+Deadline::Deadline() : start(chrono::steady_clock::now()), end(start), limited(false), cancelled(false) {}
+
+Deadline::Deadline(double seconds) : start(chrono::steady_clock::now()), limited(true), cancelled(false) {
+    end = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(seconds));
+}
+
+/**
+ * Checks if time budget is spent or solver is cancelled. After first positive answer deadline stays cancelled,
+ * so clock is not read anymore.
+ *
+ * @return True if solver should stop and return best solution found so far
+ */
+bool Deadline::expired() {
+    if (cancelled.load(memory_order_relaxed)) return true;
+    if (limited && chrono::steady_clock::now() >= end) {
+        cancelled.store(true, memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Cancels all solvers observing this deadline.
+ */
+void Deadline::cancel() {
+    cancelled.store(true, memory_order_relaxed);
+}
+
+/**
+ * @return Seconds passed since deadline was created
+ */
+double Deadline::elapsed() const {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @return Seconds left until deadline, infinity if there is no time limit
+ */
+double Deadline::remaining() const {
+    if (!limited) return numeric_limits<double>::infinity();
+    double left = chrono::duration<double>(end - chrono::steady_clock::now()).count();
+    return left > 0 ? left : 0;
+}
@@ -0,0 +1,37 @@
+#ifndef TSP_FINAL_DEADLINE_H
+#define TSP_FINAL_DEADLINE_H
+
+#include <atomic>
+#include <chrono>
+
+using namespace std;
+
+/**
+ * Wall-clock time budget shared by all solvers. Measured on the steady clock so it stays correct when several
+ * threads are burning CPU time at once. Also acts as a cancellation token, once cancelled (or expired) every
+ * following check is a single atomic load.
+ */
+class Deadline {
+public:
+    /** Deadline without time limit, expires only when cancelled. */
+    Deadline();
+
+    /** Deadline expiring after given number of seconds from now. */
+    explicit Deadline(double seconds);
+
+    bool expired();
+
+    void cancel();
+
+    double elapsed() const;
+
+    double remaining() const;
+
+private:
+    chrono::steady_clock::time_point start;
+    chrono::steady_clock::time_point end;
+    bool limited;
+    atomic<bool> cancelled;
+};
+
+#endif //TSP_FINAL_DEADLINE_H
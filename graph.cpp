@@ -15,7 +15,7 @@ using namespace std;
  * @param v2 Second vertex
  * @return Distance between two vertices
  */
-int calculateDistance(Vertex v1, Vertex v2) {
+int calculateDistance(const Vertex &v1, const Vertex &v2) {
     double dx = v1.x - v2.x;
     double dy = v1.y - v2.y;
 
@@ -38,6 +38,56 @@ int calculateTourDistance(vector<int> solution, int **distanceMatrix) {
     return sum;
 }
 
+/**
+ * Calculates distance of route from any source of distances, used when there is no distance matrix.
+ *
+ * @param solution Route for calculating total tour distance
+ * @param distances Distances between cities
+ * @return Total tour distance
+ */
+int calculateTourDistance(const vector<int> &solution, const Distances &distances) {
+    int sum = distances(solution[0], solution[solution.size() - 1]);
+    for (int i = 1; i < (int) solution.size(); ++i) {
+        sum += distances(solution[i], solution[i - 1]);
+    }
+    return sum;
+}
+
+/**
+ * Creates matrix of rounded distances between every two cities, distance of city to itself is 0.
+ *
+ * @param vertices Coordinates of cities
+ * @return Distance matrix, released with deleteDistanceMatrix
+ */
+int **createDistanceMatrix(const vector<Vertex> &vertices) {
+    int size = (int) vertices.size();
+    int **distanceMatrix = new int *[size];
+    for (int i = 0; i < size; ++i) {
+        distanceMatrix[i] = new int[size];
+        distanceMatrix[i][i] = 0;
+
+        for (int j = 0; j < i; ++j) {
+            distanceMatrix[i][j] = distanceMatrix[j][i] =
+                    calculateDistance(vertices[i], vertices[j]);
+        }
+    }
+    return distanceMatrix;
+}
+
+/**
+ * Releases matrix created by createDistanceMatrix, missing matrix is ignored.
+ *
+ * @param distanceMatrix Distance matrix
+ * @param size Number of cities
+ */
+void deleteDistanceMatrix(int **distanceMatrix, int size) {
+    if (distanceMatrix == nullptr) return;
+    for (int i = 0; i < size; ++i) {
+        delete[] distanceMatrix[i];
+    }
+    delete[] distanceMatrix;
+}
+
 map<int, vector<int>> neighborhood;
 
 /**
@@ -94,4 +144,46 @@ void initializeCandidatesList(int k, int **distanceMatrix, int size) {
     for (int i = 0; i < size; i++) {
         neighborhood[i] = findNeighbors(i, k, distanceMatrix, size);
     }
-}
\ No newline at end of file
+}
+
+/**
+ * Creates disjoint set where every element is its own component.
+ *
+ * @param size Number of elements
+ */
+DisjointSet::DisjointSet(int size) : parent(static_cast<unsigned long>(size)), rank(static_cast<unsigned long>(size), 0) {
+    for (int i = 0; i < size; ++i) {
+        parent[i] = i;
+    }
+}
+
+/**
+ * Finds representative of component containing element.
+ *
+ * @param x Element
+ * @return Representative of component
+ */
+int DisjointSet::find(int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+/**
+ * Joins components of two elements.
+ *
+ * @param a First element
+ * @param b Second element
+ * @return False if elements were already in same component
+ */
+bool DisjointSet::unite(int a, int b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) return false;
+    if (rank[a] < rank[b]) swap(a, b);
+    parent[b] = a;
+    if (rank[a] == rank[b]) rank[a]++;
+    return true;
+}
@@ -25,8 +25,53 @@ vector<int> findNeighbors(int index, int noCandidates, int **distanceMatrix, int
 
 void initializeCandidatesList(int k, int **distanceMatrix, int size);
 
-int calculateDistance(Vertex v1, Vertex v2);
+int calculateDistance(const Vertex &v1, const Vertex &v2);
 
 int calculateTourDistance(vector<int> solution, int **distanceMatrix);
 
+int **createDistanceMatrix(const vector<Vertex> &vertices);
+
+void deleteDistanceMatrix(int **distanceMatrix, int size);
+
+/**
+ * Source of distances between cities. Explicit distance matrix is used when provided, otherwise distances are
+ * calculated from coordinates, so large instances can be processed without quadratic memory. Coordinates also allow
+ * spatial structures (k-d tree) to be used instead of dense scans.
+ */
+class Distances {
+public:
+    int **matrix;
+    const vector<Vertex> *vertices;
+
+    Distances(int **matrix) : matrix(matrix), vertices(nullptr) {}
+
+    explicit Distances(const vector<Vertex> &vertices) : matrix(nullptr), vertices(&vertices) {}
+
+    Distances(int **matrix, const vector<Vertex> &vertices) : matrix(matrix), vertices(&vertices) {}
+
+    bool hasCoordinates() const { return vertices != nullptr && !vertices->empty(); }
+
+    int operator()(int i, int j) const {
+        return matrix != nullptr ? matrix[i][j] : calculateDistance((*vertices)[i], (*vertices)[j]);
+    }
+};
+
+int calculateTourDistance(const vector<int> &solution, const Distances &distances);
+
+/**
+ * Union-find structure with path compression and union by rank, used for joining components of a graph.
+ */
+class DisjointSet {
+public:
+    explicit DisjointSet(int size);
+
+    int find(int x);
+
+    bool unite(int a, int b);
+
+private:
+    vector<int> parent;
+    vector<int> rank;
+};
+
 #endif
\ No newline at end of file
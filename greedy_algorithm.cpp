@@ -1,30 +1,97 @@
 #include "vector"
+#include <memory>
+#include "greedy_algorithm.h"
+#include "kd_tree.h"
+#include "thread_pool.h"
 
 using namespace std;
 
 /**
- * Simple greedy nearest neighbor algorithm presented in project.
+ * Nearest neighbor tour using k-d tree, visited cities are removed from the tree so every step is one search.
+ * Runs in O(n log n) for cities spread in the plane.
  *
- * @param dm Distance matrix
+ * @param tree Tree containing all cities, cities are removed from it
  * @param size Size of TSP problem
+ * @param start Starting city
  * @return Solution of greedy nearest neighbor algorithm
  */
-vector<int> greedyAlgorithm(int **dm, int size) {
+vector<int> nearestNeighborTour(KdTree &tree, int size, int start) {
     vector<int> tour;
-    int used[size] = {0};
-    tour.push_back(0);
-    used[0] = 1;
+    tour.reserve(static_cast<unsigned long>(size));
+    tour.push_back(start);
+    tree.remove(start);
+    for (int i = 1; i < size; i++) {
+        int next = tree.nearestActive(tour[i - 1]);
+        tour.push_back(next);
+        tree.remove(next);
+    }
+    return tour;
+}
+
+/**
+ * Simple greedy nearest neighbor algorithm presented in project. Every step moves to closest unvisited city, searched
+ * with k-d tree when coordinates are known and by scanning all cities otherwise.
+ *
+ * @param distances Distances between cities
+ * @param size Size of TSP problem
+ * @param start Starting city
+ * @return Solution of greedy nearest neighbor algorithm
+ */
+vector<int> greedyAlgorithm(const Distances &distances, int size, int start) {
+    if (distances.hasCoordinates()) {
+        KdTree tree(*distances.vertices);
+        return nearestNeighborTour(tree, size, start);
+    }
+
+    vector<int> tour;
+    vector<bool> used(static_cast<unsigned long>(size), false);
+    tour.push_back(start);
+    used[start] = true;
 
     for (int i = 1; i < size; i++) {
         int best = -1;
         for (int j = 0; j < size; j++) {
-            if (!used[j] && (best == -1 || dm[i - 1][j] < dm[i - 1][best])) {
+            if (!used[j] && (best == -1 || distances(tour[i - 1], j) < distances(tour[i - 1], best))) {
                 best = j;
             }
         }
         tour.push_back(best);
-        used[best] = 1;
+        used[best] = true;
     }
     return tour;
+}
+
+/**
+ * Nearest neighbor algorithm from several starting cities spread over the instance, run concurrently on shared
+ * thread pool. With coordinates, k-d tree is built once and every start removes cities from its own copy.
+ *
+ * @param distances Distances between cities
+ * @param size Size of TSP problem
+ * @param starts Number of starting cities
+ * @return Shortest of obtained tours
+ */
+vector<int> multiStartGreedy(const Distances &distances, int size, int starts) {
+    starts = max(1, min(starts, size));
+    vector<vector<int>> tours(static_cast<unsigned long>(starts));
+    vector<long> lengths(static_cast<unsigned long>(starts), 0);
+    unique_ptr<KdTree> tree(distances.hasCoordinates() ? new KdTree(*distances.vertices) : nullptr);
 
-}
\ No newline at end of file
+    sharedThreadPool().parallelFor(starts, [&](int i, int /*worker*/) {
+        int start = (int) ((long) i * size / starts);
+        if (tree != nullptr) {
+            KdTree copy = *tree;
+            tours[i] = nearestNeighborTour(copy, size, start);
+        } else {
+            tours[i] = greedyAlgorithm(distances, size, start);
+        }
+        for (int j = 0; j < size; j++) {
+            lengths[i] += distances(tours[i][j], tours[i][(j + 1) % size]);
+        }
+    });
+
+    int best = 0;
+    for (int i = 1; i < starts; i++) {
+        if (lengths[i] < lengths[best]) best = i;
+    }
+    return tours[best];
+}
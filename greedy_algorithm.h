@@ -6,9 +6,12 @@
 #define TSP_FINAL_GREEDY_ALGORITHM_H
 
 #include "vector"
+#include "graph.h"
 
 using namespace std;
 
-vector<int> greedyAlgorithm(int **dm, int size);
+vector<int> greedyAlgorithm(const Distances &distances, int size, int start);
+
+vector<int> multiStartGreedy(const Distances &distances, int size, int starts);
 
 #endif //TSP_FINAL_GREEDY_ALGORITHM_H
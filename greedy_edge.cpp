@@ -0,0 +1,170 @@
+#include <vector>
+#include <algorithm>
+#include "greedy_edge.h"
+#include "matching.h"
+#include "counters.h"
+#include "trace.h"
+
+using namespace std;
+
+/** Number of nearest cities considered for edges of greedy edge tour */
+const int GREEDY_EDGE_CANDIDATES = 10;
+/** Cells of Hilbert curve grid along one side, power of two */
+const unsigned int HILBERT_ORDER = 1u << 16;
+
+/**
+ * Adding sorted edges to tour fragments, edge is taken when both cities have degree lower than two and it does not
+ * close a cycle.
+ *
+ * @param edges Candidate edges as (distance, (from, to)), sorted
+ * @param degree Degree of every city in fragments
+ * @param fragments Components of fragments
+ * @param tour Edges of fragments
+ */
+void addGreedyEdges(const vector<pair<int, pair<int, int>>> &edges, vector<int> &degree, DisjointSet &fragments,
+                    vector<pair<int, int>> &tour) {
+    for (auto &e : edges) {
+        int a = e.second.first, b = e.second.second;
+        if (degree[a] >= 2 || degree[b] >= 2 || !fragments.unite(a, b)) continue;
+        degree[a]++;
+        degree[b]++;
+        tour.push_back(e.second);
+    }
+}
+
+/**
+ * Candidate edges between nearest members of a set of cities, sorted by length.
+ *
+ * @param cities Cities of the set
+ * @param distances Distances between cities
+ * @param k Number of neighbors of every city
+ * @return Edges as (distance, (from, to))
+ */
+vector<pair<int, pair<int, int>>> candidateEdges(const vector<int> &cities, const Distances &distances, int k) {
+    vector<vector<int>> neighbors = subsetNeighbors(cities, distances, k);
+    vector<pair<int, pair<int, int>>> edges;
+    edges.reserve(cities.size() * k);
+    for (int i = 0; i < (int) cities.size(); ++i) {
+        for (int j : neighbors[i]) {
+            // Mutual neighbors share the edge, it is added from the smaller one
+            if (j < i && find(neighbors[j].begin(), neighbors[j].end(), i) != neighbors[j].end()) continue;
+            edges.push_back(make_pair(distances(cities[i], cities[j]), make_pair(cities[i], cities[j])));
+        }
+    }
+    sort(edges.begin(), edges.end());
+    return edges;
+}
+
+/**
+ * Bentley's greedy edge algorithm, shortest edges are added to tour fragments while every city has at most two edges
+ * and no cycle is closed. Only edges to nearest neighbors are considered, fragments left are joined by repeating
+ * the process on their endpoints with growing neighborhoods. Last fragment is closed into a tour. Runs in
+ * O(n log n) when coordinates are known.
+ *
+ * @param distances Distances between cities
+ * @param size Size of TSP problem
+ * @return Greedy edge tour
+ */
+vector<int> greedyEdgeTour(const Distances &distances, int size) {
+    PHASE_TIMER(CONSTRUCTION_TIMER);
+    TRACE_SCOPE("greedy_edge");
+    vector<int> degree(static_cast<unsigned long>(size), 0);
+    DisjointSet fragments(size);
+    vector<pair<int, int>> edges;
+
+    vector<int> cities(static_cast<unsigned long>(size));
+    for (int i = 0; i < size; ++i) {
+        cities[i] = i;
+    }
+    for (int k = GREEDY_EDGE_CANDIDATES; (int) edges.size() < size - 1; k *= 2) {
+        addGreedyEdges(candidateEdges(cities, distances, k), degree, fragments, edges);
+        // Only endpoints of fragments can take more edges
+        cities.clear();
+        for (int i = 0; i < size; ++i) {
+            if (degree[i] < 2) cities.push_back(i);
+        }
+    }
+
+    // Walking along the path from one of its endpoints
+    vector<int> adjacency(2 * static_cast<unsigned long>(size), -1);
+    for (auto &e : edges) {
+        adjacency[2 * e.first + (adjacency[2 * e.first] == -1 ? 0 : 1)] = e.second;
+        adjacency[2 * e.second + (adjacency[2 * e.second] == -1 ? 0 : 1)] = e.first;
+    }
+    int start = 0;
+    while (start < size - 1 && degree[start] == 2) start++;
+    vector<int> tour;
+    tour.reserve(static_cast<unsigned long>(size));
+    for (int previous = -1, current = start; current != -1 && (int) tour.size() < size;) {
+        tour.push_back(current);
+        int next = adjacency[2 * current] != previous ? adjacency[2 * current] : adjacency[2 * current + 1];
+        previous = current;
+        current = next;
+    }
+    return tour;
+}
+
+/**
+ * Position of cell on Hilbert curve filling square grid.
+ *
+ * @param order Cells along one side of grid, power of two
+ * @param x Column of cell
+ * @param y Row of cell
+ * @return Distance of cell along the curve
+ */
+long hilbertIndex(unsigned int order, unsigned int x, unsigned int y) {
+    long index = 0;
+    for (unsigned int s = order / 2; s > 0; s /= 2) {
+        unsigned int rx = (x & s) > 0;
+        unsigned int ry = (y & s) > 0;
+        index += (long) s * s * ((3 * rx) ^ ry);
+        // Rotating quadrant so curve inside of it has standard orientation
+        if (ry == 0) {
+            if (rx == 1) {
+                x = order - 1 - x;
+                y = order - 1 - y;
+            }
+            swap(x, y);
+        }
+    }
+    return index;
+}
+
+/**
+ * Visiting cities in order of Hilbert curve through the bounding box of instance. Curve keeps close cities close
+ * in the tour, so it gives tour about 25% longer than optimal in O(n log n), used as fallback when there is no time
+ * for other constructions.
+ *
+ * @param vertices Coordinates of cities
+ * @return Tour along Hilbert curve
+ */
+vector<int> hilbertCurveTour(const vector<Vertex> &vertices) {
+    PHASE_TIMER(CONSTRUCTION_TIMER);
+    TRACE_SCOPE("hilbert_curve");
+    int size = (int) vertices.size();
+    if (size == 0) return vector<int>();
+    double minX = vertices[0].x, maxX = vertices[0].x, minY = vertices[0].y, maxY = vertices[0].y;
+    for (const Vertex &v : vertices) {
+        minX = min(minX, v.x);
+        maxX = max(maxX, v.x);
+        minY = min(minY, v.y);
+        maxY = max(maxY, v.y);
+    }
+    // Same scale on both axes keeps shape of the instance
+    double side = max(max(maxX - minX, maxY - minY), 1e-9);
+    double scale = (HILBERT_ORDER - 1) / side;
+
+    vector<pair<long, int>> keys(static_cast<unsigned long>(size));
+    for (int i = 0; i < size; ++i) {
+        auto x = (unsigned int) ((vertices[i].x - minX) * scale);
+        auto y = (unsigned int) ((vertices[i].y - minY) * scale);
+        keys[i] = make_pair(hilbertIndex(HILBERT_ORDER, x, y), i);
+    }
+    sort(keys.begin(), keys.end());
+
+    vector<int> tour(static_cast<unsigned long>(size));
+    for (int i = 0; i < size; ++i) {
+        tour[i] = keys[i].second;
+    }
+    return tour;
+}
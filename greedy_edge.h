@@ -0,0 +1,15 @@
+#ifndef TSP_FINAL_GREEDY_EDGE_H
+#define TSP_FINAL_GREEDY_EDGE_H
+
+#include <vector>
+#include "graph.h"
+
+using namespace std;
+
+vector<int> greedyEdgeTour(const Distances &distances, int size);
+
+long hilbertIndex(unsigned int order, unsigned int x, unsigned int y);
+
+vector<int> hilbertCurveTour(const vector<Vertex> &vertices);
+
+#endif //TSP_FINAL_GREEDY_EDGE_H
@@ -0,0 +1,119 @@
+#include <vector>
+#include <climits>
+#include <algorithm>
+#include "held_karp.h"
+#include "trace.h"
+
+using namespace std;
+
+/** Memory for table of dynamic programming, larger instances are left to branch and bound */
+const size_t HELD_KARP_MEMORY = (size_t) 256 << 20;
+/** Value of unreachable states, small enough that adding a distance does not overflow */
+const int UNREACHABLE = INT_MAX / 4;
+/** Subsets computed between two deadline checks */
+const int DEADLINE_CHECK = 1 << 12;
+
+/**
+ * Size of table of dynamic programming, one value for every subset of cities other than 0 and its last city.
+ *
+ * @param size Number of cities
+ * @return Size of the table in bytes
+ */
+size_t heldKarpBytes(int size) {
+    return ((size_t) 1 << (size - 1)) * (size - 1) * sizeof(int);
+}
+
+/**
+ * Checks if instance of given size can be solved with Held-Karp dynamic programming within its memory budget.
+ *
+ * @param size Number of cities
+ * @return True if table fits into memory budget
+ */
+bool heldKarpFeasible(int size) {
+    return size >= 2 && size < 32 && heldKarpBytes(size) <= HELD_KARP_MEMORY;
+}
+
+/**
+ * Shortest path ending in city last, from the row of the subset without last city. Unreachable entries of the row
+ * hold large value instead of being skipped, so the loop has no branches. Four independent minimums are kept, which
+ * compiler turns into one vector minimum.
+ *
+ * @param previous Row of subset without last city
+ * @param distance Distances from last city to every city
+ * @param m Length of rows
+ * @return Length of shortest path
+ */
+inline int minimumExtension(const int *previous, const int *distance, int m) {
+    int best[4] = {UNREACHABLE, UNREACHABLE, UNREACHABLE, UNREACHABLE};
+    int i = 0;
+    for (; i + 4 <= m; i += 4) {
+        for (int k = 0; k < 4; k++) {
+            best[k] = min(best[k], previous[i + k] + distance[i + k]);
+        }
+    }
+    for (; i < m; i++) {
+        best[0] = min(best[0], previous[i] + distance[i]);
+    }
+    return min(min(best[0], best[1]), min(best[2], best[3]));
+}
+
+/**
+ * Optimal tour with Held-Karp dynamic programming. Tour starts in city 0, table holds for every subset of other
+ * cities and its last city length of shortest path from city 0 through the subset. Table is one flat array with row
+ * of all last cities for every subset, subsets are computed in increasing order so every subset comes after its
+ * subsets. Runs in O(2^n n^2) time and O(2^n n) memory.
+ *
+ * @param distances Distances between cities
+ * @param size Number of cities, instance has to be feasible
+ * @param deadline Time budget of the algorithm
+ * @return Optimal tour, empty if deadline expired
+ */
+vector<int> heldKarp(const Distances &distances, int size, Deadline &deadline) {
+    TRACE_SCOPE("held_karp");
+    int m = size - 1;
+    vector<int> distance((size_t) m * m);
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < m; j++) {
+            distance[(size_t) i * m + j] = i == j ? 0 : distances(i + 1, j + 1);
+        }
+    }
+
+    size_t subsets = (size_t) 1 << m;
+    vector<int> table(subsets * m, UNREACHABLE);
+    for (int j = 0; j < m; j++) {
+        table[((size_t) 1 << j) * m + j] = distances(0, j + 1);
+    }
+    for (size_t mask = 1; mask < subsets; mask++) {
+        if (mask % DEADLINE_CHECK == 0 && deadline.expired()) return vector<int>();
+        if ((mask & (mask - 1)) == 0) continue;
+        int *row = &table[mask * m];
+        for (int j = 0; j < m; j++) {
+            if (mask & ((size_t) 1 << j)) {
+                row[j] = minimumExtension(&table[(mask ^ ((size_t) 1 << j)) * m], &distance[(size_t) j * m], m);
+            }
+        }
+    }
+
+    size_t mask = subsets - 1;
+    int last = 0;
+    for (int j = 1; j < m; j++) {
+        if (table[mask * m + j] + distances(j + 1, 0) < table[mask * m + last] + distances(last + 1, 0)) last = j;
+    }
+    vector<int> tour;
+    while (true) {
+        tour.push_back(last + 1);
+        size_t previous = mask ^ ((size_t) 1 << last);
+        if (previous == 0) break;
+        int length = table[mask * m + last];
+        for (int i = 0; i < m; i++) {
+            if (table[previous * m + i] + distance[(size_t) last * m + i] == length) {
+                last = i;
+                break;
+            }
+        }
+        mask = previous;
+    }
+    tour.push_back(0);
+    reverse(tour.begin(), tour.end());
+    return tour;
+}
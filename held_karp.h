@@ -0,0 +1,14 @@
+#ifndef TSP_FINAL_HELD_KARP_H
+#define TSP_FINAL_HELD_KARP_H
+
+#include <vector>
+#include "graph.h"
+#include "deadline.h"
+
+using namespace std;
+
+bool heldKarpFeasible(int size);
+
+vector<int> heldKarp(const Distances &distances, int size, Deadline &deadline);
+
+#endif //TSP_FINAL_HELD_KARP_H
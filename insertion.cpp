@@ -0,0 +1,281 @@
+#include <vector>
+#include <queue>
+#include <climits>
+#include <memory>
+#include "insertion.h"
+#include "matching.h"
+#include "kd_tree.h"
+#include "counters.h"
+#include "trace.h"
+
+using namespace std;
+
+/** Number of nearest cities whose tour edges are considered for insertion of a city */
+const int INSERTION_CANDIDATES = 10;
+
+/**
+ * Partial tour built by insertion, stored as doubly linked cycle. Candidate lists bound the search for insertion
+ * position to tour edges next to nearest routed cities.
+ */
+class InsertionTour {
+public:
+    const Distances &distances;
+    int size;
+    /** Nearest cities of every city. */
+    vector<vector<int>> neighbors;
+    /** Cities having the city in their candidate list. */
+    vector<vector<int>> reverse;
+    vector<int> next;
+    vector<int> prev;
+    vector<bool> routed;
+    int routedCount = 0;
+
+    InsertionTour(const Distances &distances, int size);
+
+    int cost(int from, int city) const;
+
+    pair<int, int> bestInsertion(int city, int hint) const;
+
+    void insert(int city, int from);
+
+    vector<int> tour() const;
+};
+
+/**
+ * Creates empty tour and candidate lists.
+ *
+ * @param distances Distances between cities
+ * @param size Size of TSP problem
+ */
+InsertionTour::InsertionTour(const Distances &distances, int size)
+        : distances(distances), size(size), reverse(static_cast<unsigned long>(size)),
+          next(static_cast<unsigned long>(size), -1), prev(static_cast<unsigned long>(size), -1),
+          routed(static_cast<unsigned long>(size), false) {
+    vector<int> cities(static_cast<unsigned long>(size));
+    for (int i = 0; i < size; ++i) {
+        cities[i] = i;
+    }
+    neighbors = subsetNeighbors(cities, distances, INSERTION_CANDIDATES);
+    for (int i = 0; i < size; ++i) {
+        for (int j : neighbors[i]) {
+            reverse[j].push_back(i);
+        }
+    }
+}
+
+/**
+ * Increase of tour length when city is inserted after routed city.
+ *
+ * @param from Routed city, city is placed between it and its successor
+ * @param city Inserted city
+ * @return Cost of insertion
+ */
+int InsertionTour::cost(int from, int city) const {
+    int to = next[from];
+    return distances(from, city) + distances(city, to) - distances(from, to);
+}
+
+/**
+ * Cheapest insertion of city among tour edges next to its routed candidates and next to hint. Whole tour is searched
+ * only when none of them is routed.
+ *
+ * @param city Inserted city
+ * @param hint Routed city close to inserted one, -1 if unknown
+ * @return Cost of insertion and city after which it is inserted
+ */
+pair<int, int> InsertionTour::bestInsertion(int city, int hint) const {
+    int best = INT_MAX, bestFrom = -1;
+    auto consider = [&](int routedCity) {
+        for (int from : {prev[routedCity], routedCity}) {
+            int c = cost(from, city);
+            if (c < best) {
+                best = c;
+                bestFrom = from;
+            }
+        }
+    };
+    for (int r : neighbors[city]) {
+        if (routed[r]) consider(r);
+    }
+    if (hint != -1) consider(hint);
+    if (bestFrom == -1) {
+        for (int r = 0; r < size; ++r) {
+            if (routed[r]) consider(r);
+        }
+    }
+    return make_pair(best, bestFrom);
+}
+
+/**
+ * Inserts city into the tour after given city, first city forms a tour by itself.
+ *
+ * @param city Inserted city
+ * @param from Routed city, -1 for first city
+ */
+void InsertionTour::insert(int city, int from) {
+    if (from == -1) {
+        next[city] = prev[city] = city;
+    } else {
+        int to = next[from];
+        next[from] = city;
+        prev[city] = from;
+        next[city] = to;
+        prev[to] = city;
+    }
+    routed[city] = true;
+    routedCount++;
+}
+
+/**
+ * Converts linked cycle to sequence of cities.
+ *
+ * @return Tour starting at first inserted city
+ */
+vector<int> InsertionTour::tour() const {
+    vector<int> result;
+    result.reserve(static_cast<unsigned long>(size));
+    int start = 0;
+    while (!routed[start]) start++;
+    int city = start;
+    do {
+        result.push_back(city);
+        city = next[city];
+    } while (city != start);
+    return result;
+}
+
+/**
+ * Insertion of city into tour edge, kept in priority queue until the edge is split or city is routed.
+ */
+struct InsertionMove {
+    int cost;
+    int city;
+    int from;
+    int to;
+
+    bool operator>(const InsertionMove &other) const {
+        return cost > other.cost;
+    }
+};
+
+/**
+ * Cheapest insertion, in every step city whose insertion increases tour length least is inserted. Every unrouted city
+ * keeps its best insertion in priority queue. Moves are validated lazily when popped: move whose edge was split
+ * meanwhile is recomputed and pushed again. After insertion only cities having inserted city among candidates
+ * are offered the two new edges, so every step costs O(k log n).
+ *
+ * @param distances Distances between cities
+ * @param size Size of TSP problem
+ * @return Cheapest insertion tour
+ */
+vector<int> cheapestInsertion(const Distances &distances, int size) {
+    PHASE_TIMER(CONSTRUCTION_TIMER);
+    TRACE_SCOPE("cheapest_insertion");
+    InsertionTour tour(distances, size);
+    priority_queue<InsertionMove, vector<InsertionMove>, greater<InsertionMove>> moves;
+
+    auto offerEdges = [&](int inserted) {
+        for (const vector<int> *cities : {&tour.reverse[inserted], &tour.neighbors[inserted]}) {
+            for (int city : *cities) {
+                if (tour.routed[city]) continue;
+                for (int from : {tour.prev[inserted], inserted}) {
+                    moves.push({tour.cost(from, city), city, from, tour.next[from]});
+                }
+            }
+        }
+    };
+
+    tour.insert(0, -1);
+    offerEdges(0);
+    int unrouted = 0;
+    while (tour.routedCount < size) {
+        if (moves.empty()) {
+            // Cities without routed candidates are reached by searching the whole tour
+            while (tour.routed[unrouted]) unrouted++;
+            pair<int, int> best = tour.bestInsertion(unrouted, -1);
+            tour.insert(unrouted, best.second);
+            offerEdges(unrouted);
+            continue;
+        }
+        InsertionMove move = moves.top();
+        moves.pop();
+        if (tour.routed[move.city]) continue;
+        if (tour.next[move.from] != move.to) {
+            pair<int, int> best = tour.bestInsertion(move.city, move.from);
+            moves.push({best.first, move.city, best.second, tour.next[best.second]});
+            continue;
+        }
+        tour.insert(move.city, move.from);
+        offerEdges(move.city);
+    }
+    return tour.tour();
+}
+
+/**
+ * Farthest insertion, in every step city farthest from the tour is inserted at its cheapest position. Distance of
+ * every unrouted city to the tour only decreases, so it is kept in max priority queue as upper estimate updated for
+ * candidates of inserted city. Estimate on top of queue is verified against nearest routed city, found with k-d tree
+ * containing only routed cities, or by scanning the tour without coordinates. Verified top is the farthest city and
+ * its nearest routed city serves as hint for insertion position.
+ *
+ * @param distances Distances between cities
+ * @param size Size of TSP problem
+ * @return Farthest insertion tour
+ */
+vector<int> farthestInsertion(const Distances &distances, int size) {
+    PHASE_TIMER(CONSTRUCTION_TIMER);
+    TRACE_SCOPE("farthest_insertion");
+    InsertionTour tour(distances, size);
+    vector<int> distance(static_cast<unsigned long>(size));
+    vector<int> closest(static_cast<unsigned long>(size), 0);
+    priority_queue<pair<int, int>> farthest;
+
+    unique_ptr<KdTree> routedTree(distances.hasCoordinates() ? new KdTree(*distances.vertices) : nullptr);
+    if (routedTree != nullptr) {
+        for (int i = 1; i < size; ++i) {
+            routedTree->remove(i);
+        }
+    }
+    auto nearestRouted = [&](int city) {
+        if (routedTree != nullptr) return routedTree->nearestActive(city);
+        int nearest = -1;
+        for (int r = 0; r < size; ++r) {
+            if (tour.routed[r] && (nearest == -1 || distances(city, r) < distances(city, nearest))) nearest = r;
+        }
+        return nearest;
+    };
+
+    tour.insert(0, -1);
+    for (int i = 1; i < size; ++i) {
+        distance[i] = distances(0, i);
+        farthest.push(make_pair(distance[i], i));
+    }
+    while (!farthest.empty()) {
+        pair<int, int> top = farthest.top();
+        farthest.pop();
+        int city = top.second;
+        if (tour.routed[city] || top.first != distance[city]) continue;
+        int nearest = nearestRouted(city);
+        if (distances(city, nearest) < distance[city]) {
+            distance[city] = distances(city, nearest);
+            closest[city] = nearest;
+            farthest.push(make_pair(distance[city], city));
+            continue;
+        }
+
+        tour.insert(city, tour.bestInsertion(city, closest[city]).second);
+        if (routedTree != nullptr) routedTree->restore(city);
+        for (const vector<int> *cities : {&tour.reverse[city], &tour.neighbors[city]}) {
+            for (int other : *cities) {
+                if (tour.routed[other]) continue;
+                int d = distances(city, other);
+                if (d < distance[other]) {
+                    distance[other] = d;
+                    closest[other] = city;
+                    farthest.push(make_pair(d, other));
+                }
+            }
+        }
+    }
+    return tour.tour();
+}
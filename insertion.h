@@ -0,0 +1,13 @@
+#ifndef TSP_FINAL_INSERTION_H
+#define TSP_FINAL_INSERTION_H
+
+#include <vector>
+#include "graph.h"
+
+using namespace std;
+
+vector<int> cheapestInsertion(const Distances &distances, int size);
+
+vector<int> farthestInsertion(const Distances &distances, int size);
+
+#endif //TSP_FINAL_INSERTION_H
@@ -0,0 +1,54 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include "instances.h"
+
+using namespace std;
+
+/** Default seed of generated instances */
+const unsigned long DEFAULT_INSTANCE_SEED = 1;
+
+/**
+ * Generates synthetic instance into samples directory, so it can be run by name like bundled samples:
+ *
+ * instance_generator <uniform|clustered|grid> <cities> [--seed <n>] [--binary] [--output <file>]
+ *
+ * Default file is samples/<kind>_<cities>_<seed>.tsp, or .bin in binary format.
+ */
+int main(int argc, char *argv[]) {
+    InstanceKind kind;
+    if (argc < 3 || !parseInstanceKind(argv[1], &kind) || atoi(argv[2]) <= 0) {
+        cerr << "Usage: instance_generator <uniform|clustered|grid> <cities> [--seed <n>] [--binary] "
+                "[--output <file>]" << endl;
+        return 2;
+    }
+    int size = atoi(argv[2]);
+    unsigned long seed = DEFAULT_INSTANCE_SEED;
+    bool binary = false;
+    string output;
+    for (int i = 3; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--binary") {
+            binary = true;
+        } else if (option == "--seed" && i + 1 < argc) {
+            seed = strtoul(argv[++i], nullptr, 10);
+        } else if (option == "--output" && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            cerr << "Unknown option " << option << endl;
+            return 2;
+        }
+    }
+    if (output.empty()) {
+        output = "samples/" + string(argv[1]) + "_" + to_string(size) + "_" + to_string(seed) +
+                 (binary ? ".bin" : ".tsp");
+    }
+
+    vector<Vertex> vertices = generateInstance(kind, size, seed);
+    if (!(binary ? writeBinaryInstance(output, vertices) : writeTextInstance(output, vertices))) {
+        cerr << "Can not write " << output << endl;
+        return 1;
+    }
+    cout << output << endl;
+    return 0;
+}
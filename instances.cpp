@@ -0,0 +1,178 @@
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <iomanip>
+#include <random>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include "instances.h"
+
+using namespace std;
+
+/** Distance between neighboring cities of grid, square side is chosen so other kinds have the same density */
+const double GRID_SPACING = 100;
+/** Cities per cluster of clustered instances */
+const int CLUSTER_SIZE = 100;
+/** Largest move of grid city by noise, relative to grid spacing */
+const double GRID_NOISE = 0.1;
+/** First bytes of binary instance */
+const char BINARY_MAGIC[4] = {'T', 'S', 'P', 'B'};
+
+/**
+ * Parses kind of instance from its name: uniform, clustered or grid.
+ *
+ * @param name Name of kind
+ * @param kind Parsed kind
+ * @return False if name is not known
+ */
+bool parseInstanceKind(const string &name, InstanceKind *kind) {
+    if (name == "uniform") {
+        *kind = UNIFORM_INSTANCE;
+    } else if (name == "clustered") {
+        *kind = CLUSTERED_INSTANCE;
+    } else if (name == "grid") {
+        *kind = GRID_INSTANCE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Generates synthetic instance. Cities lie in a square whose side grows with square root of their number, so density
+ * and typical distance to nearest neighbor do not depend on size. Same kind, size and seed give the same instance.
+ *
+ * @param kind Kind of instance
+ * @param size Number of cities
+ * @param seed Seed of the generator
+ * @return Coordinates of cities
+ */
+vector<Vertex> generateInstance(InstanceKind kind, int size, unsigned long seed) {
+    mt19937_64 random(seed);
+    int columns = (int) ceil(sqrt((double) size));
+    double side = columns * GRID_SPACING;
+    uniform_real_distribution<double> coordinate(0, side);
+    vector<Vertex> vertices;
+    vertices.reserve(static_cast<unsigned long>(size));
+
+    if (kind == UNIFORM_INSTANCE) {
+        for (int i = 0; i < size; i++) {
+            vertices.emplace_back(coordinate(random), coordinate(random), i);
+        }
+    } else if (kind == CLUSTERED_INSTANCE) {
+        int clusters = max(1, size / CLUSTER_SIZE);
+        vector<pair<double, double>> centers;
+        for (int c = 0; c < clusters; c++) {
+            centers.emplace_back(coordinate(random), coordinate(random));
+        }
+        normal_distribution<double> spread(0, side / (4 * sqrt((double) clusters)));
+        uniform_int_distribution<int> cluster(0, clusters - 1);
+        for (int i = 0; i < size; i++) {
+            const pair<double, double> &center = centers[cluster(random)];
+            vertices.emplace_back(center.first + spread(random), center.second + spread(random), i);
+        }
+    } else {
+        uniform_real_distribution<double> noise(-GRID_NOISE * GRID_SPACING, GRID_NOISE * GRID_SPACING);
+        for (int i = 0; i < size; i++) {
+            vertices.emplace_back((i % columns) * GRID_SPACING + noise(random),
+                                  (i / columns) * GRID_SPACING + noise(random), i);
+        }
+    }
+    return vertices;
+}
+
+/**
+ * Reads instance in text format of samples directory, one line with coordinates of every city.
+ *
+ * @param path Path of the file
+ * @param vertices Vector receiving coordinates of cities
+ * @return False if file can not be opened
+ */
+bool readTextInstance(const string &path, vector<Vertex> &vertices) {
+    ifstream inputFile(path);
+    if (!inputFile) return false;
+    string oneLine;
+
+    while (inputFile) {
+        getline(inputFile, oneLine);
+        istringstream coordinates(oneLine);
+
+        vector<string> tokens{istream_iterator<string>{coordinates},
+                              istream_iterator<string>{}};
+
+        if (tokens.size() < 2) break;
+
+        Vertex v = Vertex(stod(tokens[0]), stod(tokens[1]));
+        vertices.push_back(v);
+    }
+
+    inputFile.close();
+    return true;
+}
+
+/**
+ * Writes instance in text format of samples directory.
+ *
+ * @param path Path of the file
+ * @param vertices Coordinates of cities
+ * @return False if file can not be written
+ */
+bool writeTextInstance(const string &path, const vector<Vertex> &vertices) {
+    ofstream outputFile(path);
+    if (!outputFile) return false;
+    outputFile << fixed << setprecision(3);
+    for (const Vertex &v : vertices) {
+        outputFile << v.x << " " << v.y << "\n";
+    }
+    return (bool) outputFile;
+}
+
+/**
+ * Reads instance in binary format: 4 bytes "TSPB", number of cities as 32-bit integer and two doubles with
+ * coordinates of every city, all in byte order of the machine.
+ *
+ * @param path Path of the file
+ * @param vertices Vector receiving coordinates of cities
+ * @return False if file can not be opened or is not in binary format
+ */
+bool readBinaryInstance(const string &path, vector<Vertex> &vertices) {
+    ifstream inputFile(path, ios::binary);
+    char magic[4];
+    int32_t size;
+    if (!inputFile.read(magic, sizeof(magic)) || memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0) return false;
+    if (!inputFile.read(reinterpret_cast<char *>(&size), sizeof(size)) || size < 0) return false;
+
+    vector<double> coordinates(2 * static_cast<size_t>(size));
+    if (!inputFile.read(reinterpret_cast<char *>(coordinates.data()), coordinates.size() * sizeof(double))) {
+        return false;
+    }
+    vertices.reserve(vertices.size() + size);
+    for (int i = 0; i < size; i++) {
+        vertices.emplace_back(coordinates[2 * i], coordinates[2 * i + 1], i);
+    }
+    return true;
+}
+
+/**
+ * Writes instance in binary format, see readBinaryInstance.
+ *
+ * @param path Path of the file
+ * @param vertices Coordinates of cities
+ * @return False if file can not be written
+ */
+bool writeBinaryInstance(const string &path, const vector<Vertex> &vertices) {
+    ofstream outputFile(path, ios::binary);
+    if (!outputFile) return false;
+    int32_t size = (int32_t) vertices.size();
+    vector<double> coordinates;
+    coordinates.reserve(2 * vertices.size());
+    for (const Vertex &v : vertices) {
+        coordinates.push_back(v.x);
+        coordinates.push_back(v.y);
+    }
+    outputFile.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    outputFile.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    outputFile.write(reinterpret_cast<const char *>(coordinates.data()), coordinates.size() * sizeof(double));
+    return (bool) outputFile;
+}
@@ -0,0 +1,32 @@
+#ifndef TSP_FINAL_INSTANCES_H
+#define TSP_FINAL_INSTANCES_H
+
+#include <string>
+#include <vector>
+#include "graph.h"
+
+using namespace std;
+
+/**
+ * Kinds of synthetic instances:
+ *  UNIFORM_INSTANCE    -   Cities uniformly distributed in a square
+ *  CLUSTERED_INSTANCE  -   Cities normally distributed around uniformly placed centers, about 100 per center
+ *  GRID_INSTANCE       -   Cities on a square grid moved by small uniform noise
+ */
+enum InstanceKind {
+    UNIFORM_INSTANCE, CLUSTERED_INSTANCE, GRID_INSTANCE
+};
+
+bool parseInstanceKind(const string &name, InstanceKind *kind);
+
+vector<Vertex> generateInstance(InstanceKind kind, int size, unsigned long seed);
+
+bool readTextInstance(const string &path, vector<Vertex> &vertices);
+
+bool writeTextInstance(const string &path, const vector<Vertex> &vertices);
+
+bool readBinaryInstance(const string &path, vector<Vertex> &vertices);
+
+bool writeBinaryInstance(const string &path, const vector<Vertex> &vertices);
+
+#endif //TSP_FINAL_INSTANCES_H
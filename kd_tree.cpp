@@ -0,0 +1,284 @@
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include "kd_tree.h"
+#include "trace.h"
+
+using namespace std;
+
+/** Maximal number of cities in leaf node. */
+const int LEAF_SIZE = 8;
+
+/**
+ * Builds tree over all cities.
+ *
+ * @param vertices Coordinates of cities, have to outlive the tree
+ */
+KdTree::KdTree(const vector<Vertex> &vertices) : vertices(vertices), leafOf(vertices.size()),
+                                                  removed(vertices.size(), false) {
+    order.resize(vertices.size());
+    for (int i = 0; i < (int) vertices.size(); i++) {
+        order[i] = i;
+    }
+    nodes.reserve(2 * vertices.size() / LEAF_SIZE + 1);
+    if (!vertices.empty()) build(0, (int) vertices.size(), -1);
+    // Coordinates in tree order, so leaves are scanned without jumping through memory
+    points.reserve(vertices.size());
+    for (int city : order) {
+        points.push_back(vertices[city]);
+    }
+}
+
+/**
+ * Builds node over range of cities, splitting at median of wider side of bounding box.
+ *
+ * @param begin First position in order
+ * @param end Position after last in order
+ * @param parent Index of parent node, -1 for root
+ * @return Index of created node
+ */
+int KdTree::build(int begin, int end, int parent) {
+    Node node;
+    node.begin = begin;
+    node.end = end;
+    node.left = node.right = -1;
+    node.parent = parent;
+    node.active = end - begin;
+    node.label = -1;
+    node.minX = node.minY = numeric_limits<double>::max();
+    node.maxX = node.maxY = numeric_limits<double>::lowest();
+    for (int i = begin; i < end; i++) {
+        const Vertex &v = vertices[order[i]];
+        node.minX = min(node.minX, v.x);
+        node.maxX = max(node.maxX, v.x);
+        node.minY = min(node.minY, v.y);
+        node.maxY = max(node.maxY, v.y);
+    }
+    int index = (int) nodes.size();
+    nodes.push_back(node);
+    if (end - begin <= LEAF_SIZE) {
+        for (int i = begin; i < end; i++) {
+            leafOf[order[i]] = index;
+        }
+        return index;
+    }
+
+    int middle = begin + (end - begin) / 2;
+    bool splitX = node.maxX - node.minX >= node.maxY - node.minY;
+    nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end, [&](int a, int b) {
+        return splitX ? vertices[a].x < vertices[b].x : vertices[a].y < vertices[b].y;
+    });
+    int left = build(begin, middle, index);
+    int right = build(middle, end, index);
+    nodes[index].left = left;
+    nodes[index].right = right;
+    return index;
+}
+
+/**
+ * Squared distance from city to bounding box of node, zero if city is inside.
+ */
+double KdTree::boxDistance(const Node &node, const Vertex &v) const {
+    double dx = v.x < node.minX ? node.minX - v.x : (v.x > node.maxX ? v.x - node.maxX : 0);
+    double dy = v.y < node.minY ? node.minY - v.y : (v.y > node.maxY ? v.y - node.maxY : 0);
+    return dx * dx + dy * dy;
+}
+
+/**
+ * Squared euclidean distance between two cities.
+ */
+double KdTree::squaredDistance(const Vertex &a, const Vertex &b) {
+    double dx = a.x - b.x;
+    double dy = a.y - b.y;
+    return dx * dx + dy * dy;
+}
+
+/**
+ * Finds k nearest cities of a city, closest first.
+ *
+ * @param index Searched city
+ * @param k Number of neighbors
+ * @return Nearest cities, without the city itself
+ */
+vector<int> KdTree::nearest(int index, int k) const {
+    vector<pair<double, int>> heap;
+    if (k > 0 && !nodes.empty()) searchNearest(0, vertices[index], index, k, heap);
+    sort_heap(heap.begin(), heap.end());
+    vector<int> neighbors;
+    for (auto &entry : heap) {
+        neighbors.push_back(entry.second);
+    }
+    return neighbors;
+}
+
+/**
+ * Finds k nearest cities of every city. Cities are processed in tree order, so consecutive searches visit same
+ * parts of the tree.
+ *
+ * @param k Number of neighbors
+ * @return Nearest cities of every city, closest first
+ */
+vector<vector<int>> KdTree::allNearest(int k) const {
+    TRACE_SCOPE("candidate_lists");
+    vector<vector<int>> neighbors(vertices.size());
+    vector<pair<double, int>> heap;
+    for (int i = 0; i < (int) order.size(); i++) {
+        heap.clear();
+        if (k > 0) searchNearest(0, points[i], order[i], k, heap);
+        sort_heap(heap.begin(), heap.end());
+        vector<int> &list = neighbors[order[i]];
+        list.reserve(heap.size());
+        for (auto &entry : heap) {
+            list.push_back(entry.second);
+        }
+    }
+    return neighbors;
+}
+
+/**
+ * Depth first search keeping k closest cities in max heap, nearer child is visited first.
+ */
+void KdTree::searchNearest(int node, const Vertex &query, int index, int k, vector<pair<double, int>> &heap) const {
+    const Node &n = nodes[node];
+    if (n.left == -1) {
+        for (int i = n.begin; i < n.end; i++) {
+            int city = order[i];
+            if (city == index) continue;
+            double distance = squaredDistance(query, points[i]);
+            if ((int) heap.size() < k) {
+                heap.emplace_back(distance, city);
+                push_heap(heap.begin(), heap.end());
+            } else if (distance < heap.front().first) {
+                pop_heap(heap.begin(), heap.end());
+                heap.back() = make_pair(distance, city);
+                push_heap(heap.begin(), heap.end());
+            }
+        }
+        return;
+    }
+    int first = n.left, second = n.right;
+    double firstDistance = boxDistance(nodes[first], query), secondDistance = boxDistance(nodes[second], query);
+    if (secondDistance < firstDistance) {
+        swap(first, second);
+        swap(firstDistance, secondDistance);
+    }
+    if ((int) heap.size() < k || firstDistance < heap.front().first) searchNearest(first, query, index, k, heap);
+    if ((int) heap.size() < k || secondDistance < heap.front().first) searchNearest(second, query, index, k, heap);
+}
+
+/**
+ * Recomputes labels of nodes, so searches for cities with different label can skip nodes where all cities share
+ * the label of searched city.
+ *
+ * @param labels Label of every city
+ */
+void KdTree::updateLabels(const vector<int> &labels) {
+    // Children always come after their parent, so reverse order handles them first
+    for (int i = (int) nodes.size() - 1; i >= 0; i--) {
+        Node &n = nodes[i];
+        if (n.left == -1) {
+            n.label = labels[order[n.begin]];
+            for (int j = n.begin + 1; j < n.end && n.label != -1; j++) {
+                if (labels[order[j]] != n.label) n.label = -1;
+            }
+        } else {
+            n.label = nodes[n.left].label == nodes[n.right].label ? nodes[n.left].label : -1;
+        }
+    }
+}
+
+/**
+ * Finds nearest city having different label than searched city. Labels of nodes have to be up to date.
+ *
+ * @param index Searched city
+ * @param labels Label of every city
+ * @return Nearest city with different label, -1 if there is none
+ */
+int KdTree::nearestOutside(int index, const vector<int> &labels) const {
+    double best = numeric_limits<double>::max();
+    int bestIndex = -1;
+    if (!nodes.empty()) searchOutside(0, vertices[index], index, labels, best, bestIndex);
+    return bestIndex;
+}
+
+void KdTree::searchOutside(int node, const Vertex &query, int index, const vector<int> &labels, double &best,
+                           int &bestIndex) const {
+    const Node &n = nodes[node];
+    if (n.label == labels[index] || boxDistance(n, query) >= best) return;
+    if (n.left == -1) {
+        for (int i = n.begin; i < n.end; i++) {
+            int city = order[i];
+            if (labels[city] == labels[index]) continue;
+            double distance = squaredDistance(query, points[i]);
+            if (distance < best) {
+                best = distance;
+                bestIndex = city;
+            }
+        }
+        return;
+    }
+    int first = n.left, second = n.right;
+    if (boxDistance(nodes[second], query) < boxDistance(nodes[first], query)) swap(first, second);
+    searchOutside(first, query, index, labels, best, bestIndex);
+    searchOutside(second, query, index, labels, best, bestIndex);
+}
+
+/**
+ * Removes city from the tree, so it is not returned by searches for active cities.
+ *
+ * @param index Removed city
+ */
+void KdTree::remove(int index) {
+    if (removed[index]) return;
+    removed[index] = true;
+    for (int node = leafOf[index]; node != -1; node = nodes[node].parent) {
+        nodes[node].active--;
+    }
+}
+
+/**
+ * Returns removed city back to the tree.
+ *
+ * @param index Restored city
+ */
+void KdTree::restore(int index) {
+    if (!removed[index]) return;
+    removed[index] = false;
+    for (int node = leafOf[index]; node != -1; node = nodes[node].parent) {
+        nodes[node].active++;
+    }
+}
+
+/**
+ * Finds nearest city which was not removed from the tree.
+ *
+ * @param index Searched city
+ * @return Nearest active city other than searched one, -1 if there is none
+ */
+int KdTree::nearestActive(int index) const {
+    double best = numeric_limits<double>::max();
+    int bestIndex = -1;
+    if (!nodes.empty()) searchActive(0, vertices[index], index, best, bestIndex);
+    return bestIndex;
+}
+
+void KdTree::searchActive(int node, const Vertex &query, int index, double &best, int &bestIndex) const {
+    const Node &n = nodes[node];
+    if (n.active == 0 || boxDistance(n, query) >= best) return;
+    if (n.left == -1) {
+        for (int i = n.begin; i < n.end; i++) {
+            int city = order[i];
+            if (city == index || removed[city]) continue;
+            double distance = squaredDistance(query, points[i]);
+            if (distance < best) {
+                best = distance;
+                bestIndex = city;
+            }
+        }
+        return;
+    }
+    int first = n.left, second = n.right;
+    if (boxDistance(nodes[second], query) < boxDistance(nodes[first], query)) swap(first, second);
+    searchActive(first, query, index, best, bestIndex);
+    searchActive(second, query, index, best, bestIndex);
+}
@@ -0,0 +1,71 @@
+#ifndef TSP_FINAL_KD_TREE_H
+#define TSP_FINAL_KD_TREE_H
+
+#include <vector>
+#include "graph.h"
+
+using namespace std;
+
+/**
+ * Two dimensional k-d tree over cities, used for nearest neighbor queries on instances too large for distance matrix.
+ * Built in O(n log n), every node keeps bounding box of its cities for pruning. Cities can be removed from the tree,
+ * nodes count remaining cities so emptied parts are skipped. Copies share nothing but coordinates, so every thread can
+ * remove cities from its own copy.
+ */
+class KdTree {
+public:
+    explicit KdTree(const vector<Vertex> &vertices);
+
+    vector<int> nearest(int index, int k) const;
+
+    vector<vector<int>> allNearest(int k) const;
+
+    void updateLabels(const vector<int> &labels);
+
+    int nearestOutside(int index, const vector<int> &labels) const;
+
+    void remove(int index);
+
+    void restore(int index);
+
+    int nearestActive(int index) const;
+
+private:
+    struct Node {
+        int begin;
+        int end;
+        int left;
+        int right;
+        double minX, maxX, minY, maxY;
+        int parent;
+        /** Number of cities of the node not removed from the tree. */
+        int active;
+        /** Label shared by all cities of the node, -1 if they differ. */
+        int label;
+    };
+
+    int build(int begin, int end, int parent);
+
+    double boxDistance(const Node &node, const Vertex &v) const;
+
+    static double squaredDistance(const Vertex &a, const Vertex &b);
+
+    void searchNearest(int node, const Vertex &query, int index, int k, vector<pair<double, int>> &heap) const;
+
+    void searchOutside(int node, const Vertex &query, int index, const vector<int> &labels, double &best,
+                       int &bestIndex) const;
+
+    void searchActive(int node, const Vertex &query, int index, double &best, int &bestIndex) const;
+
+    const vector<Vertex> &vertices;
+    /** Permutation of cities, every node owns a contiguous range of it. */
+    vector<int> order;
+    /** Coordinates of cities aligned with order. */
+    vector<Vertex> points;
+    vector<Node> nodes;
+    /** Leaf node containing every city. */
+    vector<int> leafOf;
+    vector<bool> removed;
+};
+
+#endif //TSP_FINAL_KD_TREE_H
@@ -0,0 +1,235 @@
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <climits>
+#include "matching.h"
+#include "kd_tree.h"
+
+using namespace std;
+
+/** Largest relative perturbation of edge lengths in randomized greedy matching */
+const double MATCHING_NOISE = 0.2;
+/** Largest set matched exactly, dynamic programming takes O(2^m) memory */
+const int EXACT_MATCHING_LIMIT = 20;
+
+/**
+ * Collecting vertices that have odd number of joined edges.
+ *
+ * @param edges Edges of graph
+ * @param size Number of vertices
+ * @return Vertices with odd degree
+ */
+vector<int> oddDegreeVertices(const vector<pair<int, int>> &edges, int size) {
+    vector<int> degree(static_cast<unsigned long>(size), 0);
+    for (const pair<int, int> &e : edges) {
+        degree[e.first]++;
+        degree[e.second]++;
+    }
+    vector<int> odd;
+    for (int i = 0; i < size; ++i) {
+        if (degree[i] % 2 == 1) odd.push_back(i);
+    }
+    return odd;
+}
+
+/**
+ * Finding k nearest vertices inside of subset for every vertex of subset. K-d tree is used when coordinates are
+ * known, otherwise distances to whole subset are inspected.
+ *
+ * @param subset Vertices of graph
+ * @param distances Distances between vertices
+ * @param k Number of neighbors
+ * @return Neighbors of every vertex as positions in subset
+ */
+vector<vector<int>> subsetNeighbors(const vector<int> &subset, const Distances &distances, int k) {
+    int m = (int) subset.size();
+    k = min(k, m - 1);
+    vector<vector<int>> neighbors(static_cast<unsigned long>(m));
+    if (k <= 0) return neighbors;
+
+    if (distances.hasCoordinates()) {
+        vector<Vertex> vertices;
+        vertices.reserve(static_cast<unsigned long>(m));
+        for (int v : subset) {
+            vertices.push_back((*distances.vertices)[v]);
+        }
+        return KdTree(vertices).allNearest(k);
+    }
+
+    vector<pair<int, int>> candidates;
+    for (int i = 0; i < m; ++i) {
+        candidates.clear();
+        for (int j = 0; j < m; ++j) {
+            if (j != i) candidates.emplace_back(distances(subset[i], subset[j]), j);
+        }
+        partial_sort(candidates.begin(), candidates.begin() + k, candidates.end());
+        for (int j = 0; j < k; ++j) {
+            neighbors[i].push_back(candidates[j].second);
+        }
+    }
+    return neighbors;
+}
+
+/**
+ * Greedy matching over candidate edges between nearest odd vertices. Edges are sorted by length and every edge whose
+ * both endpoints are still free is taken. Vertices left without partner are matched in next round with larger
+ * neighborhood. Matching is then improved with 2-exchanges, replacing pairs (a, b), (c, d) with (a, c), (b, d) when
+ * that is shorter.
+ *
+ * @param odd Vertices with odd degree, even number of them
+ * @param distances Distances between vertices
+ * @return Pairs of matched vertices
+ */
+vector<pair<int, int>> greedyEdgeMatching(const vector<int> &odd, const Distances &distances) {
+    return greedyEdgeMatching(odd, subsetNeighbors(odd, distances, MATCHING_CANDIDATES), distances, nullptr);
+}
+
+/**
+ * Greedy matching with precomputed candidates, so they can be shared between several matchings of same vertices.
+ * When random stream is provided, edge lengths are perturbed before sorting to obtain different matchings.
+ *
+ * @param odd Vertices with odd degree, even number of them
+ * @param neighbors Nearest odd vertices of every odd vertex, as positions in odd
+ * @param distances Distances between vertices
+ * @param random Random stream for perturbation, nullptr for plain greedy matching
+ * @return Pairs of matched vertices
+ */
+vector<pair<int, int>> greedyEdgeMatching(const vector<int> &odd, const vector<vector<int>> &neighbors,
+                                          const Distances &distances, RandomStream *random) {
+    int m = (int) odd.size();
+    vector<int> partner(static_cast<unsigned long>(m), -1);
+
+    // Positions in odd of vertices still without partner
+    vector<int> unmatched(static_cast<unsigned long>(m));
+    for (int i = 0; i < m; ++i) {
+        unmatched[i] = i;
+    }
+    for (int k = MATCHING_CANDIDATES; !unmatched.empty(); k *= 2) {
+        // Shared candidates are used in first round, later rounds search only among vertices left unmatched
+        const vector<vector<int>> *candidates = &neighbors;
+        vector<vector<int>> wider;
+        if ((int) unmatched.size() < m) {
+            vector<int> subset;
+            for (int i : unmatched) {
+                subset.push_back(odd[i]);
+            }
+            wider = subsetNeighbors(subset, distances, k);
+            candidates = &wider;
+        }
+
+        vector<pair<double, pair<int, int>>> edges;
+        for (int i = 0; i < (int) unmatched.size(); ++i) {
+            for (int j : (*candidates)[i]) {
+                double length = distances(odd[unmatched[i]], odd[unmatched[j]]);
+                if (random != nullptr) length *= 1 + MATCHING_NOISE * random->fRand();
+                edges.push_back(make_pair(length, make_pair(unmatched[i], unmatched[j])));
+            }
+        }
+        sort(edges.begin(), edges.end());
+        for (auto &e : edges) {
+            int a = e.second.first, b = e.second.second;
+            if (partner[a] != -1 || partner[b] != -1) continue;
+            partner[a] = b;
+            partner[b] = a;
+        }
+
+        vector<int> left;
+        for (int i : unmatched) {
+            if (partner[i] == -1) left.push_back(i);
+        }
+        unmatched = left;
+    }
+
+    // Vertices are checked again only when their partner changed, so work does not repeat over whole set
+    deque<int> queue;
+    vector<char> queued(static_cast<unsigned long>(m), 1);
+    for (int a = 0; a < m; ++a) {
+        queue.push_back(a);
+    }
+    while (!queue.empty()) {
+        int a = queue.front();
+        queue.pop_front();
+        queued[a] = 0;
+        for (int c : neighbors[a]) {
+            int b = partner[a], d = partner[c];
+            if (c == b) continue;
+            int before = distances(odd[a], odd[b]) + distances(odd[c], odd[d]);
+            int after = distances(odd[a], odd[c]) + distances(odd[b], odd[d]);
+            if (after < before) {
+                partner[a] = c;
+                partner[c] = a;
+                partner[b] = d;
+                partner[d] = b;
+                for (int v : {a, b, c, d}) {
+                    if (queued[v]) continue;
+                    queued[v] = 1;
+                    queue.push_back(v);
+                }
+            }
+        }
+    }
+
+    vector<pair<int, int>> matching;
+    for (int i = 0; i < m; ++i) {
+        if (i < partner[i]) matching.emplace_back(odd[i], odd[partner[i]]);
+    }
+    return matching;
+}
+
+/**
+ * Checks if set of given size can be matched exactly.
+ *
+ * @param count Number of vertices
+ * @return True if exact matching is feasible
+ */
+bool exactMatchingFeasible(int count) {
+    return count <= EXACT_MATCHING_LIMIT;
+}
+
+/**
+ * Minimum weight perfect matching with dynamic programming over subsets, lowest unmatched vertex is always paired
+ * first so every matching is counted once. Runs in O(2^m m), used for small sets where it replaces Blossom algorithm.
+ * Greedy matching is used for sets that are too large.
+ *
+ * @param odd Vertices with odd degree, even number of them
+ * @param distances Distances between vertices
+ * @return Pairs of matched vertices
+ */
+vector<pair<int, int>> exactMatching(const vector<int> &odd, const Distances &distances) {
+    int m = (int) odd.size();
+    if (!exactMatchingFeasible(m)) return greedyEdgeMatching(odd, distances);
+
+    vector<vector<int>> cost(static_cast<unsigned long>(m), vector<int>(static_cast<unsigned long>(m)));
+    for (int i = 0; i < m; ++i) {
+        for (int j = 0; j < m; ++j) {
+            cost[i][j] = distances(odd[i], odd[j]);
+        }
+    }
+
+    int full = (1 << m) - 1;
+    vector<int> best(static_cast<unsigned long>(full) + 1, INT_MAX);
+    // Pair added last to reach subset in best matching, encoded as i * m + j
+    vector<short> last(static_cast<unsigned long>(full) + 1, -1);
+    best[0] = 0;
+    for (int mask = 0; mask < full; ++mask) {
+        if (best[mask] == INT_MAX) continue;
+        int i = 0;
+        while (mask & (1 << i)) i++;
+        for (int j = i + 1; j < m; ++j) {
+            if (mask & (1 << j)) continue;
+            int next = mask | (1 << i) | (1 << j);
+            if (best[mask] + cost[i][j] < best[next]) {
+                best[next] = best[mask] + cost[i][j];
+                last[next] = static_cast<short>(i * m + j);
+            }
+        }
+    }
+
+    vector<pair<int, int>> matching;
+    for (int mask = full; mask != 0;) {
+        int i = last[mask] / m, j = last[mask] % m;
+        matching.emplace_back(odd[i], odd[j]);
+        mask &= ~((1 << i) | (1 << j));
+    }
+    return matching;
+}
@@ -0,0 +1,37 @@
+#ifndef TSP_FINAL_MATCHING_H
+#define TSP_FINAL_MATCHING_H
+
+#include <vector>
+#include "graph.h"
+#include "random_provider.h"
+
+using namespace std;
+
+/** Number of nearest odd vertices considered as partners of every odd vertex */
+const int MATCHING_CANDIDATES = 8;
+
+/**
+ * Strategy for matching vertices with odd degree in Christofides algorithm:
+ *  TOUR_MATCHING       -   Pairs consecutive vertices of greedy tour through odd vertices, O(m^2)
+ *  GREEDY_MATCHING     -   Greedy over sorted candidate edges followed by 2-exchange improvement, O(m k log m)
+ *  EXACT_MATCHING      -   Minimum weight perfect matching, only for small sets, greedy is used otherwise
+ *  AUTO_MATCHING       -   Exact matching for small sets, greedy otherwise
+ */
+enum MatchingMode {
+    TOUR_MATCHING, GREEDY_MATCHING, EXACT_MATCHING, AUTO_MATCHING
+};
+
+vector<int> oddDegreeVertices(const vector<pair<int, int>> &edges, int size);
+
+vector<vector<int>> subsetNeighbors(const vector<int> &subset, const Distances &distances, int k);
+
+vector<pair<int, int>> greedyEdgeMatching(const vector<int> &odd, const Distances &distances);
+
+vector<pair<int, int>> greedyEdgeMatching(const vector<int> &odd, const vector<vector<int>> &neighbors,
+                                          const Distances &distances, RandomStream *random);
+
+vector<pair<int, int>> exactMatching(const vector<int> &odd, const Distances &distances);
+
+bool exactMatchingFeasible(int count);
+
+#endif //TSP_FINAL_MATCHING_H
@@ -0,0 +1,294 @@
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <algorithm>
+#include "graph.h"
+#include "opt2local.h"
+#include "christofides.h"
+#include "matching.h"
+#include "simulated_annealing.h"
+#include "ant_colony_optimization.h"
+#include "branch_bound.h"
+#include "deadline.h"
+
+using namespace std;
+
+/** Default instance sizes every kernel is measured at */
+const vector<int> DEFAULT_SIZES = {100, 500, 2000};
+/** Default minimum measured time of one repetition in seconds */
+const double DEFAULT_MIN_TIME = 0.2;
+/** Repetitions of every measurement, median of them is reported */
+const int REPETITIONS = 3;
+/** Candidates per city used by kernels with candidate lists */
+const int BENCH_CANDIDATES = 10;
+
+/** Results of measured operations are added here, so compiler can not remove the operations */
+volatile long sink = 0;
+
+/**
+ * Options of micro benchmarks.
+ */
+struct MicroOptions {
+    vector<int> sizes = DEFAULT_SIZES;
+    string filter;
+    double minTime = DEFAULT_MIN_TIME;
+    bool csv = false;
+};
+
+/**
+ * Random instance of a benchmark with its distance matrix and a random tour, all fixed by instance size.
+ */
+struct BenchInstance {
+    int size;
+    vector<Vertex> vertices;
+    int **distanceMatrix;
+    vector<int> tour;
+
+    explicit BenchInstance(int size) : size(size) {
+        mt19937 random((unsigned int) size);
+        uniform_real_distribution<double> coordinate(0, 10 * size);
+        for (int i = 0; i < size; i++) {
+            vertices.emplace_back(coordinate(random), coordinate(random), i);
+        }
+        distanceMatrix = createDistanceMatrix(vertices);
+        for (int i = 0; i < size; i++) {
+            tour.push_back(i);
+        }
+        shuffle(tour.begin(), tour.end(), random);
+    }
+
+    BenchInstance(const BenchInstance &) = delete;
+
+    BenchInstance &operator=(const BenchInstance &) = delete;
+
+    ~BenchInstance() {
+        deleteDistanceMatrix(distanceMatrix, size);
+    }
+};
+
+/**
+ * Measures operation, number of operations per repetition is doubled until repetition takes at least minimum time.
+ * Median of repetitions is printed as time per operation and throughput of operations and of processed items.
+ *
+ * @param options Options of micro benchmarks
+ * @param name Name of the kernel
+ * @param size Instance size
+ * @param items Items processed by one operation (distances, edges, steps)
+ * @param operation Operation taking its index
+ */
+void measure(const MicroOptions &options, const string &name, int size, double items,
+             const function<void(long)> &operation) {
+    long iterations = 1;
+    double seconds = 0;
+    while (true) {
+        auto begin = chrono::steady_clock::now();
+        for (long i = 0; i < iterations; i++) {
+            operation(i);
+        }
+        seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        if (seconds >= options.minTime) break;
+        iterations *= 2;
+    }
+
+    vector<double> perOperation = {seconds / iterations};
+    for (int repetition = 1; repetition < REPETITIONS; repetition++) {
+        auto begin = chrono::steady_clock::now();
+        for (long i = 0; i < iterations; i++) {
+            operation(i);
+        }
+        perOperation.push_back(chrono::duration<double>(chrono::steady_clock::now() - begin).count() / iterations);
+    }
+    sort(perOperation.begin(), perOperation.end());
+    double median = perOperation[REPETITIONS / 2];
+
+    if (options.csv) {
+        cout << name << "," << size << "," << iterations << "," << median * 1e9 << "," << 1 / median << ","
+             << items / median << endl;
+    } else {
+        cout << left << setw(28) << name << right << setw(8) << size << setw(12) << iterations << setw(16)
+             << fixed << setprecision(1) << median * 1e9 << setw(16) << setprecision(1) << 1 / median << setw(16)
+             << scientific << setprecision(3) << items / median << defaultfloat << endl;
+    }
+}
+
+/**
+ * Runs every kernel whose name contains the filter at given instance size.
+ *
+ * @param options Options of micro benchmarks
+ * @param size Instance size
+ */
+void benchSize(const MicroOptions &options, int size) {
+    BenchInstance instance(size);
+    int **distanceMatrix = instance.distanceMatrix;
+    const vector<Vertex> &vertices = instance.vertices;
+    Distances distances(distanceMatrix, vertices);
+    Deadline unlimited;
+    auto selected = [&](const string &name) {
+        return name.find(options.filter) != string::npos;
+    };
+
+    if (selected("calculateDistance")) {
+        measure(options, "calculateDistance", size, 1, [&](long i) {
+            sink += calculateDistance(vertices[i % size], vertices[(i * 7 + 1) % size]);
+        });
+    }
+    if (selected("createDistanceMatrix")) {
+        measure(options, "createDistanceMatrix", size, (double) size * size, [&](long) {
+            int **matrix = createDistanceMatrix(vertices);
+            sink += matrix[size - 1][0];
+            deleteDistanceMatrix(matrix, size);
+        });
+    }
+    if (selected("findNeighbors")) {
+        measure(options, "findNeighbors", size, size, [&](long i) {
+            sink += findNeighbors((int) (i % size), BENCH_CANDIDATES, distanceMatrix, size)[0];
+        });
+    }
+    if (selected("opt2Pass")) {
+        measure(options, "opt2Pass", size, (double) size * size / 2, [&](long) {
+            vector<int> tour = instance.tour;
+            tour.push_back(tour[0]);
+            opt2Pass(tour, distanceMatrix, size, unlimited);
+            sink += tour[1];
+        });
+    }
+    if (selected("saMoveEvaluation")) {
+        Neighborhood neighborhood;
+        measure(options, "saMoveEvaluation", size, 1, [&](long i) {
+            int n1 = (int) (i % size), n2 = (int) ((i * 7 + 3) % size);
+            vector<int> neighbor = neighborhood.createNeighbor(instance.tour, n1, n2, distanceMatrix);
+            sink += calculateTourDistance(neighbor, distanceMatrix) - calculateTourDistance(instance.tour, distanceMatrix);
+        });
+    }
+    if (selected("walkGraph")) {
+        AntColonyOptimization optimization(distanceMatrix, vertices, size);
+        optimization.initializeHeuristicDistances();
+        optimization.initializeCandidates(size / 5);
+        optimization.initializeParameters();
+        optimization.initializePheromones();
+        optimization.computeChoiceInformation();
+        AntColony colony(1, optimization);
+        Ant ant(size, nullptr);
+        measure(options, "walkGraph", size, size, [&](long i) {
+            ant.random.seed((unsigned long) i);
+            sink += (long) colony.walkGraph(ant).distance;
+        });
+    }
+    if (selected("oneTree")) {
+        SearchWorker worker(distanceMatrix, size);
+        CityNode *root = worker.pool.acquire();
+        fill(root->penalties, root->penalties + size, 0.0);
+        root->path.push_back(0);
+        for (int i = 1; i < size; i++) {
+            root->notUsed.push_back(i);
+        }
+        measure(options, "oneTree", size, (double) size * size / 2, [&](long) {
+            sink += (long) worker.oneTree(root);
+        });
+        worker.pool.release(root);
+    }
+
+    vector<pair<int, int>> mst;
+    minimumSpanningTree(mst, distances, size);
+    vector<pair<int, int>> joined = mst;
+    minWeightMatching(joined, distances, size, AUTO_MATCHING);
+    vector<int> circuit = eulerTour(joined, size);
+    if (selected("minimumSpanningTree")) {
+        measure(options, "minimumSpanningTree", size, size, [&](long) {
+            vector<pair<int, int>> tree;
+            minimumSpanningTree(tree, distances, size);
+            sink += tree.size();
+        });
+    }
+    if (selected("greedyMinWeightMatching")) {
+        measure(options, "greedyMinWeightMatching", size, size, [&](long) {
+            vector<pair<int, int>> edges = mst;
+            greedyMinWeightMatching(edges, distances, size);
+            sink += edges.size();
+        });
+    }
+    if (selected("minWeightMatching")) {
+        measure(options, "minWeightMatching", size, size, [&](long) {
+            vector<pair<int, int>> edges = mst;
+            minWeightMatching(edges, distances, size, AUTO_MATCHING);
+            sink += edges.size();
+        });
+    }
+    if (selected("eulerTour")) {
+        measure(options, "eulerTour", size, joined.size(), [&](long) {
+            sink += eulerTour(joined, size).size();
+        });
+    }
+    if (selected("hamiltonianPath")) {
+        measure(options, "hamiltonianPath", size, circuit.size(), [&](long) {
+            sink += hamiltonianPath(circuit, distances, size, false)[1];
+        });
+        measure(options, "hamiltonianPathBest", size, circuit.size(), [&](long) {
+            sink += hamiltonianPath(circuit, distances, size, true)[1];
+        });
+    }
+}
+
+/**
+ * Parses command line options.
+ *
+ * @param argc Number of arguments
+ * @param argv Arguments
+ * @param options Parsed options
+ * @return False if options are invalid
+ */
+bool parseMicroOptions(int argc, char *argv[], MicroOptions &options) {
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--csv") {
+            options.csv = true;
+            continue;
+        }
+        if (i + 1 >= argc) return false;
+        string value = argv[++i];
+        char *end;
+        if (option == "--sizes") {
+            options.sizes.clear();
+            istringstream stream(value);
+            string size;
+            while (getline(stream, size, ',')) {
+                options.sizes.push_back((int) strtol(size.c_str(), &end, 10));
+                if (*end != '\0' || options.sizes.back() < 4) return false;
+            }
+        } else if (option == "--filter") {
+            options.filter = value;
+        } else if (option == "--min-time") {
+            options.minTime = strtod(value.c_str(), &end);
+            if (*end != '\0' || options.minTime <= 0) return false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Micro benchmarks of solver kernels on random uniform instances.
+ */
+int main(int argc, char *argv[]) {
+    MicroOptions options;
+    if (!parseMicroOptions(argc, argv, options)) {
+        cerr << "Usage: micro_bench [--sizes n,n,...] [--filter <kernel>] [--min-time <seconds>] [--csv]" << endl;
+        return 2;
+    }
+    if (options.csv) {
+        cout << "kernel,size,iterations,ns_per_op,ops_per_s,items_per_s" << endl;
+    } else {
+        cout << left << setw(28) << "kernel" << right << setw(8) << "size" << setw(12) << "iterations" << setw(16)
+             << "ns/op" << setw(16) << "ops/s" << setw(16) << "items/s" << endl;
+    }
+    for (int size : options.sizes) {
+        benchSize(options, size);
+    }
+    return 0;
+}
@@ -1,46 +1,170 @@
 #include <vector>
+#include <deque>
 #include "graph.h"
 #include "opt2local.h"
+#include "kd_tree.h"
+#include "deadline.h"
+#include "counters.h"
+#include "trace.h"
 
 using namespace std;
 
+/** Nearest neighbors of every city searched by neighbor list 2-opt */
+const int OPT2_NEIGHBORS = 8;
+
 /**
- * Algorithm performing the 2-opt optimization till solution doesn't change
+ * One pass of 2-opt over all pairs of edges of the route, every improving exchange is applied immediately.
+ *
+ * @param v Route with first city repeated at the end
+ * @param distanceMatrix Distance matrix of TSP problem
+ * @param size Size of TSP problem
+ * @param deadline Time budget, pass stops early on expiry
+ */
+void opt2Pass(vector<int> &v, int **distanceMatrix, int size, Deadline &deadline) {
+    TRACE_SCOPE("opt2_pass");
+    COUNT(OPT2_PASSES, 1);
+    for (int i = 0; i < size - 3; i++) {
+        if (deadline.expired()) break;
+        COUNT(OPT2_MOVES_EVALUATED, size - i - 2);
+        for (int j = i + 2; j < size; j++) {
+            if (distanceMatrix[v[i]][v[i + 1]] + distanceMatrix[v[j]][v[j + 1]] >
+                distanceMatrix[v[i]][v[j]] + distanceMatrix[v[i + 1]][v[j + 1]]) {
+                COUNT(OPT2_MOVES_APPLIED, 1);
+                for (int k = 0; k < (j - i) / 2; k++) {
+                    int a = v[j - k];
+                    v[j - k] = v[i + k + 1];
+                    v[i + k + 1] = a;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Algorithm performing the 2-opt optimization till solution doesn't change or deadline expires
  *
  * @param path Input into algorithm
  * @param distanceMatrix Distance matrix of TSP problem
  * @param size Size of TSP problem
+ * @param deadline Time budget, on expiry best route found so far is returned
  * @return Route after performing several 2-opt optimizations.
  */
-vector<int> opt2Algorithm(vector<int> path, int **distanceMatrix, int size) {
+vector<int> opt2Algorithm(vector<int> path, int **distanceMatrix, int size, Deadline &deadline) {
     if (size <= 3) return path;
+    PHASE_TIMER(LOCAL_SEARCH_TIMER);
     int bestDistance = calculateTourDistance(path, distanceMatrix);
     vector<int> best = vector<int>(path);
     vector<int> v = vector<int>(path);
 
     while (true) {
         v.push_back(v[0]);
-        for (int i = 0; i < size - 3; i++) {
-            for (int j = i + 2; j < size; j++) {
-                if (distanceMatrix[v[i]][v[i + 1]] + distanceMatrix[v[j]][v[j + 1]] >
-                    distanceMatrix[v[i]][v[j]] + distanceMatrix[v[i + 1]][v[j + 1]]) {
-                    for (int k = 0; k < (j - i) / 2; k++) {
-                        int a = v[j - k];
-                        v[j - k] = v[i + k + 1];
-                        v[i + k + 1] = a;
-                    }
-                }
-            }
-        }
+        opt2Pass(v, distanceMatrix, size, deadline);
         v.pop_back();
         int distance = calculateTourDistance(v, distanceMatrix);
         if (distance >= bestDistance) break;
         best = vector<int>(v);
         bestDistance = distance;
+        if (deadline.expired()) break;
     }
     return best;
 }
 
+/**
+ * 2-opt restricted to neighbor lists, for instances too large for distance matrix. Exchanges are searched only between
+ * edges of a city and edges of its nearest neighbors closer than its tour neighbor. Cities wait in a queue and return
+ * to it only when one of their tour edges changes (don't look bits). Tour is kept as array with position of every
+ * city and shorter side of the tour is reversed, so a move costs at most n/2 swaps. Neighbor list of a city is found
+ * when the city is first taken from the queue, so building lists for millions of cities also stops at the deadline.
+ * Runs till no improving exchange is left or deadline expires.
+ *
+ * @param path Input into algorithm
+ * @param distances Distances between cities, with coordinates
+ * @param size Size of TSP problem
+ * @param deadline Time budget, on expiry route improved so far is returned
+ * @return Route after 2-opt optimization
+ */
+vector<int> opt2Neighbors(vector<int> path, const Distances &distances, int size, Deadline &deadline) {
+    if (size <= 3 || deadline.expired()) return path;
+    PHASE_TIMER(LOCAL_SEARCH_TIMER);
+    TRACE_SCOPE("opt2_neighbors");
+    KdTree tree(*distances.vertices);
+    vector<vector<int>> neighbors(static_cast<unsigned long>(size));
+    vector<int> position(static_cast<unsigned long>(size));
+    for (int i = 0; i < size; i++) {
+        position[path[i]] = i;
+    }
+    auto next = [&](int city) {
+        return path[position[city] + 1 == size ? 0 : position[city] + 1];
+    };
+    auto previous = [&](int city) {
+        return path[position[city] == 0 ? size - 1 : position[city] - 1];
+    };
+    // Reverses cities from position i forward to position j, or the rest of the tour when it is shorter
+    auto reverse = [&](int i, int j) {
+        int length = (j - i + size) % size + 1;
+        if (2 * length > size) {
+            int begin = (j + 1) % size;
+            j = (i - 1 + size) % size;
+            i = begin;
+            length = size - length;
+        }
+        for (int k = 0; k < length / 2; k++) {
+            int a = path[i], b = path[j];
+            path[i] = b;
+            position[b] = i;
+            path[j] = a;
+            position[a] = j;
+            i = i + 1 == size ? 0 : i + 1;
+            j = j == 0 ? size - 1 : j - 1;
+        }
+    };
+
+    deque<int> queue(path.begin(), path.end());
+    vector<char> queued(static_cast<unsigned long>(size), 1);
+    auto push = [&](int city) {
+        if (queued[city]) return;
+        queued[city] = 1;
+        queue.push_back(city);
+    };
+    for (long step = 1; !queue.empty(); step++) {
+        if (step % 256 == 0 && deadline.expired()) break;
+        int a = queue.front();
+        queue.pop_front();
+        queued[a] = 0;
+        if (neighbors[a].empty()) neighbors[a] = tree.nearest(a, OPT2_NEIGHBORS);
+        // Direction 0 exchanges edges (a, next a) and (c, next c), direction 1 edges (previous a, a) and (previous c, c)
+        for (int direction = 0; direction < 2; direction++) {
+            int b = direction == 0 ? next(a) : previous(a);
+            int ab = distances(a, b);
+            int c = -1, d = -1;
+            for (int candidate : neighbors[a]) {
+                int ac = distances(a, candidate);
+                if (ac >= ab) break;
+                int after = direction == 0 ? next(candidate) : previous(candidate);
+                if (candidate == b || after == a) continue;
+                COUNT(OPT2_MOVES_EVALUATED, 1);
+                if (ac + distances(b, after) < ab + distances(candidate, after)) {
+                    c = candidate;
+                    d = after;
+                    break;
+                }
+            }
+            if (c == -1) continue;
+            COUNT(OPT2_MOVES_APPLIED, 1);
+            if (direction == 0) {
+                reverse(position[b], position[c]);
+            } else {
+                reverse(position[a], position[d]);
+            }
+            for (int city : {a, b, c, d}) {
+                push(city);
+            }
+            break;
+        }
+    }
+    return path;
+}
+
 /**
  * Faster computing 2-OPT by only looking to the nearest neighbors
  * # NOT USED
@@ -2,10 +2,16 @@
 #define TSP_FINAL_OPT2LOCAL_H
 
 #include <vector>
+#include "graph.h"
+#include "deadline.h"
 
 using namespace std;
 
-vector<int> opt2Algorithm(vector<int> path, int **distanceMatrix, int size);
+void opt2Pass(vector<int> &v, int **distanceMatrix, int size, Deadline &deadline);
+
+vector<int> opt2Algorithm(vector<int> path, int **distanceMatrix, int size, Deadline &deadline);
+
+vector<int> opt2Neighbors(vector<int> path, const Distances &distances, int size, Deadline &deadline);
 
 vector<int> opt2Speeded(vector<int> path, int **distanceMatrix, int size);
 
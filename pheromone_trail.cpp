@@ -0,0 +1,178 @@
+#include <vector>
+#include "pheromone_trail.h"
+
+using namespace std;
+
+/** Decay factor under which stored levels are rescaled, so they never underflow. */
+const double MIN_SCALE = 1e-100;
+
+/**
+ * Sets every edge to the same pheromone level, discarding previous levels.
+ *
+ * @param candidateTable Candidate lists of all cities, listSize consecutive cities per city, has to outlive the trail
+ * @param cities Number of cities
+ * @param listSize Length of candidate list of every city
+ * @param level Starting pheromone level
+ */
+void PheromoneTrail::initialize(const int *candidateTable, int cities, int listSize, double level) {
+    candidates = candidateTable;
+    size = cities;
+    k = listSize;
+    scale = 1;
+    base = level;
+    levels.assign(static_cast<unsigned long>(size) * k, level);
+    extra.resize(static_cast<unsigned long>(size));
+    for (auto &edges : extra) {
+        edges.clear();
+    }
+}
+
+/**
+ * Sets minimal and maximal pheromone level, applied on every read.
+ *
+ * @param minimum tauMIN
+ * @param maximum tauMAX
+ */
+void PheromoneTrail::setLimits(double minimum, double maximum) {
+    tauMin = minimum;
+    tauMax = maximum;
+}
+
+/**
+ * Evaporates pheromones on all edges by lowering global decay factor.
+ *
+ * @param ro Evaporation rate
+ */
+void PheromoneTrail::evaporate(double ro) {
+    scale *= 1 - ro;
+    if (scale < MIN_SCALE) normalize();
+}
+
+/**
+ * Adds pheromones to an edge, level is capped by tauMAX. If the edge is missing from candidate list of one of its
+ * cities, it is kept as extra edge of that city, so both cities see the same level.
+ *
+ * @param i City 1
+ * @param j City 2
+ * @param amount Amount of pheromones added
+ */
+void PheromoneTrail::deposit(int i, int j, double amount) {
+    bool inFirst = false;
+    for (long r = (long) i * k, end = r + k; r < end && !inFirst; r++) {
+        if (candidates[r] != j) continue;
+        store(levels[r], read(levels[r]) + amount);
+        inFirst = true;
+    }
+    bool inSecond = false;
+    for (long r = (long) j * k, end = r + k; r < end && !inSecond; r++) {
+        if (candidates[r] != i) continue;
+        store(levels[r], read(levels[r]) + amount);
+        inSecond = true;
+    }
+    if (!inFirst) depositExtra(i, j, amount);
+    if (!inSecond) depositExtra(j, i, amount);
+}
+
+/**
+ * Adds pheromones to an edge outside of candidate lists, stored in list of the first city. Entries which evaporated
+ * to tauMIN are dropped on the way, they read the same as default level.
+ *
+ * @param i City owning the entry
+ * @param j Other city
+ * @param amount Amount of pheromones added
+ */
+void PheromoneTrail::depositExtra(int i, int j, double amount) {
+    vector<pair<int, double>> &edges = extra[i];
+    bool found = false;
+    for (unsigned long r = 0; r < edges.size();) {
+        if (edges[r].first == j) {
+            store(edges[r].second, read(edges[r].second) + amount);
+            found = true;
+        } else if (read(edges[r].second) <= tauMin) {
+            edges[r] = edges.back();
+            edges.pop_back();
+            continue;
+        }
+        r++;
+    }
+    if (!found) {
+        edges.emplace_back(j, 0);
+        store(edges.back().second, read(base) + amount);
+    }
+}
+
+/**
+ * @param i City
+ * @param r Position of other city in candidate list of the city
+ * @return Pheromone level of candidate edge
+ */
+double PheromoneTrail::candidateLevel(int i, int r) const {
+    return read(levels[(long) i * k + r]);
+}
+
+/**
+ * @return Pheromone level of edges outside of candidate lists
+ */
+double PheromoneTrail::defaultLevel() const {
+    return read(base);
+}
+
+/**
+ * Edges outside of candidate lists of the city which had pheromones deposited. Pairs hold other city and stored
+ * level, level has to be read with extraLevel.
+ *
+ * @param i City
+ * @return Extra edges of the city
+ */
+const vector<pair<int, double>> &PheromoneTrail::extraEdges(int i) const {
+    return extra[i];
+}
+
+/**
+ * @param i City
+ * @param r Position of edge in extra edges of the city
+ * @return Pheromone level of extra edge
+ */
+double PheromoneTrail::extraLevel(int i, int r) const {
+    return read(extra[i][r].second);
+}
+
+/**
+ * Applies decay factor and limits to stored level.
+ *
+ * @param stored Stored level
+ * @return Pheromone level
+ */
+double PheromoneTrail::read(double stored) const {
+    double level = stored * scale;
+    if (level < tauMin) return tauMin;
+    if (level > tauMax) return tauMax;
+    return level;
+}
+
+/**
+ * Stores pheromone level, capped by tauMAX, so that it reads back unchanged under current decay factor.
+ *
+ * @param stored Stored level to be overwritten
+ * @param level Pheromone level
+ */
+void PheromoneTrail::store(double &stored, double level) {
+    stored = (level < tauMax ? level : tauMax) / scale;
+}
+
+/**
+ * Folds decay factor into stored levels. Levels under tauMIN are raised to it, which does not change what is read
+ * since tauMIN only grows during the run.
+ */
+void PheromoneTrail::normalize() {
+    for (double &stored : levels) {
+        stored = stored * scale > tauMin ? stored * scale : tauMin;
+    }
+    for (auto &row : extra) {
+        for (auto &edge : row) {
+            edge.second = edge.second * scale > tauMin ? edge.second * scale : tauMin;
+        }
+    }
+    base = base * scale > tauMin ? base * scale : tauMin;
+    scale = 1;
+}
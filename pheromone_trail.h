@@ -0,0 +1,60 @@
+#ifndef TSP_FINAL_PHEROMONE_TRAIL_H
+#define TSP_FINAL_PHEROMONE_TRAIL_H
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * Pheromone levels of ant colony kept only on candidate list edges, every other edge shares one default level.
+ * Edges outside of candidate lists which get pheromones deposited (best route leaving candidate lists) are kept in
+ * short per city lists until they evaporate back to tauMIN. Evaporation is lazy: stored values are multiplied by
+ * global decay factor and clamped to [tauMIN, tauMAX] when read, so evaporating costs O(1) and memory is O(n * k)
+ * instead of O(n^2).
+ */
+class PheromoneTrail {
+public:
+    PheromoneTrail() : candidates(nullptr), size(0), k(0), base(0), scale(1), tauMin(0), tauMax(0) {};
+
+    void initialize(const int *candidateTable, int cities, int listSize, double level);
+
+    void setLimits(double minimum, double maximum);
+
+    void evaporate(double ro);
+
+    void deposit(int i, int j, double amount);
+
+    double candidateLevel(int i, int r) const;
+
+    double defaultLevel() const;
+
+    const vector<pair<int, double>> &extraEdges(int i) const;
+
+    double extraLevel(int i, int r) const;
+
+private:
+    double read(double stored) const;
+
+    void store(double &stored, double level);
+
+    void depositExtra(int i, int j, double amount);
+
+    void normalize();
+
+    /** Candidate lists of all cities, k consecutive cities per city. */
+    const int *candidates;
+    int size;
+    int k;
+    /** Stored levels of candidate edges, aligned with candidate lists, before applying decay factor. */
+    vector<double> levels;
+    /** Edges outside of candidate list of the city with stored levels above default. */
+    vector<vector<pair<int, double>>> extra;
+    /** Stored level of edges outside of candidate lists. */
+    double base;
+    /** Global decay factor of all stored levels. */
+    double scale;
+    double tauMin;
+    double tauMax;
+};
+
+#endif //TSP_FINAL_PHEROMONE_TRAIL_H
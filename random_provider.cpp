@@ -1,5 +1,7 @@
 
 #include <random>
+#include <mutex>
+#include "random_provider.h"
 
 using namespace std;
 
@@ -30,4 +32,67 @@ std::uniform_real_distribution<> uniform(0.0, 1.0);
  */
 double fRand() {
     return uniform(rnd);
-}
\ No newline at end of file
+}
+
+/** Guards global generator when seeds are drawn from several threads. */
+std::mutex seedLock;
+
+/**
+ * Draws seed for independent random stream from global generator, so streams are reproducible when global
+ * generator is. Unlike iRand and fRand it can be called from any thread.
+ *
+ * @return Seed for random stream
+ */
+unsigned long nextSeed() {
+    std::lock_guard<std::mutex> guard(seedLock);
+    return rnd();
+}
+
+/**
+ * Restarts global generator with given seed, so following run draws the same numbers and seeds of random streams.
+ *
+ * @param seed Seed of global generator
+ */
+void seedRandom(unsigned long seed) {
+    std::lock_guard<std::mutex> guard(seedLock);
+    rnd.seed(static_cast<std::mt19937::result_type>(seed));
+}
+
+/**
+ * Restarts stream with new seed.
+ *
+ * @param seed Seed of the stream
+ */
+void RandomStream::seed(unsigned long seed) {
+    engine.seed(static_cast<std::mt19937::result_type>(seed));
+}
+
+/**
+ * Random integer from uniform distribution between lower and upper bounds.
+ *
+ * @param lowerBound Lower bound for random integer
+ * @param upperBound Upper bound for random integer
+ * @return Random integer between lower and upper bound
+ */
+int RandomStream::iRand(unsigned long lowerBound, unsigned long upperBound) {
+    std::uniform_int_distribution<std::mt19937::result_type> distribution(lowerBound, upperBound);
+    return static_cast<int>(distribution(engine));
+}
+
+/**
+ * Random number from uniform distribution bounded from 0 - 1
+ *
+ * @return Random double from uniform distribution
+ */
+double RandomStream::fRand() {
+    return std::uniform_real_distribution<>(0.0, 1.0)(engine);
+}
+
+/**
+ * Draws seed for another stream, all 32 bits of the generator output.
+ *
+ * @return Seed for random stream
+ */
+unsigned long RandomStream::nextSeed() {
+    return engine();
+}
@@ -1,7 +1,30 @@
 #ifndef TSP_FINAL_RANDOM_PROVIDER_H
 #define TSP_FINAL_RANDOM_PROVIDER_H
 
+#include <random>
+
 int iRand(unsigned long lowerBound, unsigned long upperBound);
 double fRand();
+unsigned long nextSeed();
+void seedRandom(unsigned long seed);
+
+/**
+ * Independent random number stream, used where several threads need random numbers at once.
+ */
+class RandomStream {
+public:
+    explicit RandomStream(unsigned long seed) : engine(seed) {};
+
+    void seed(unsigned long seed);
+
+    int iRand(unsigned long lowerBound, unsigned long upperBound);
+
+    double fRand();
+
+    unsigned long nextSeed();
+
+private:
+    std::mt19937 engine;
+};
 
 #endif //TSP_FINAL_RANDOM_PROVIDER_H
@@ -0,0 +1,220 @@
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <iterator>
+#include <fstream>
+#include <chrono>
+#include "runner.h"
+#include "instances.h"
+#include "opt2local.h"
+#include "christofides.h"
+#include "sia.h"
+#include "simulated_annealing.h"
+#include "ant_colony_optimization.h"
+#include "branch_bound.h"
+#include "greedy_edge.h"
+#include "insertion.h"
+#include "counters.h"
+#include "trace.h"
+
+using namespace std;
+
+/** Number of randomized Christofides constructions run before improvement algorithms */
+const int CONSTRUCTION_STARTS = 8;
+/** Population size of SIA, -- aware of MAGIC CONSTANTS */
+const int SIA_POPULATION = 9;
+/** Largest instance solved by greedy edge construction by default, Hilbert curve is used above it */
+const int GREEDY_CITIES = 100000;
+
+/**
+ * Reads input from /sample directory right next to binary file, <file>.tsp in text format or <file>.bin in binary
+ * format
+ *
+ * @param size Size of TSP instance
+ * @param file File from which we read TSP instance
+ * @param vertices Coordinates of cities
+ * @return  Distance matrix from TSP tour, nullptr for instances larger than MATRIX_CITIES
+ */
+int **readFileInput(int *size, const string &file, vector<Vertex> &vertices) {
+    string dir = "./samples/";
+    {
+        PHASE_TIMER(READ_TIMER);
+        TRACE_SCOPE("read");
+        if (!readTextInstance(dir + file + ".tsp", vertices)) {
+            readBinaryInstance(dir + file + ".bin", vertices);
+        }
+    }
+
+    *size = (int) vertices.size();
+    if (*size > MATRIX_CITIES) return nullptr;
+    PHASE_TIMER(MATRIX_TIMER);
+    TRACE_SCOPE("matrix");
+    return createDistanceMatrix(vertices);
+}
+
+/**
+ * Reads input from standard IO stream. First reads number of cities followed by coordinates of each.
+ *
+ * @param size Size of TSP instance
+ * @param vertices Coordinates of cities
+ * @return  Distance matrix from TSP tour, nullptr for instances larger than MATRIX_CITIES
+ */
+int **readInput(int *size, vector<Vertex> &vertices) {
+    {
+        PHASE_TIMER(READ_TIMER);
+        TRACE_SCOPE("read");
+        cin >> *size;
+        string oneLine;
+
+        cin.ignore();
+        for (int i = 0; i < *size; ++i) {
+            std::getline(cin, oneLine);
+            istringstream coordinates(oneLine);
+
+            vector<string> tokens{istream_iterator<string>{coordinates},
+                                  istream_iterator<string>{}};
+
+            Vertex v = Vertex(stod(tokens[0]), stod(tokens[1]), i);
+            vertices.push_back(v);
+        }
+    }
+
+    if (*size > MATRIX_CITIES) return nullptr;
+    PHASE_TIMER(MATRIX_TIMER);
+    TRACE_SCOPE("matrix");
+    return createDistanceMatrix(vertices);
+}
+
+/**
+ * @param alg Code of algorithm
+ * @return True if algorithm can solve instance without distance matrix
+ */
+bool solvesOnCoordinates(const string &alg) {
+    return alg == "CHRISTOFIDES" || alg == "GREEDY" || alg == "HILBERT" || alg == "CHEAPEST" || alg == "FARTHEST";
+}
+
+/**
+ * Solves instance too large for distance matrix, construction on coordinates is followed by neighbor list 2-opt.
+ * Only algorithms accepted by solvesOnCoordinates are supported.
+ *
+ * @param alg Code of algorithm
+ * @param vertices Coordinates of cities
+ * @param size Size of TSP tour
+ * @param deadline Time budget of the algorithm
+ * @return Tour
+ */
+vector<int> solveOnCoordinates(const string &alg, const vector<Vertex> &vertices, int size, Deadline &deadline) {
+    if (!solvesOnCoordinates(alg)) {
+        cout << "ALGORITHM needs distance matrix, instance has more than " << MATRIX_CITIES << " cities" << endl;
+        exit(1);
+    }
+    Distances distances(vertices);
+    vector<int> solution;
+    if (alg == "CHRISTOFIDES") {
+        return multiStartChristofides(distances, nullptr, size, CONSTRUCTION_STARTS, 1, deadline)[0].first;
+    } else if (alg == "GREEDY") {
+        solution = greedyEdgeTour(distances, size);
+    } else if (alg == "HILBERT") {
+        solution = hilbertCurveTour(vertices);
+    } else if (alg == "CHEAPEST") {
+        solution = cheapestInsertion(distances, size);
+    } else {
+        solution = farthestInsertion(distances, size);
+    }
+    return opt2Neighbors(solution, distances, size, deadline);
+}
+
+/**
+ * Runs specific algorithm, can be choosed from:
+ *  CHRISTOFIDES    -   Christofides' algorithm
+ *  SIA             -   Simple immunological algorithm on top of Christofides construction
+ *  ACO             -   Ant colony optimization algorithm
+ *  SA              -   Simulated annealing on top of Christofides
+ *  BNB             -   Branch and Bound algorithm for small instances
+ *  GREEDY          -   Greedy edge construction followed by Opt2
+ *  HILBERT         -   Hilbert curve construction followed by Opt2, fastest fallback
+ *  CHEAPEST        -   Cheapest insertion construction followed by Opt2
+ *  FARTHEST        -   Farthest insertion construction followed by Opt2
+ * Without distance matrix, constructions work on coordinates and are followed by neighbor list 2-opt.
+ *
+ * @param alg Code of algorithm
+ * @param distanceMatrix Distance matrix, nullptr for large instances
+ * @param vertices Coordinates of cities
+ * @param size Size of TSP tour
+ * @param deadline Time budget shared by all stages of the algorithm
+ * @return solution of specific algorithm
+ */
+Solution runSpecific(const string &alg, int **distanceMatrix, const vector<Vertex> &vertices, int size,
+                     Deadline &deadline) {
+    TRACE_SCOPE("solve");
+    auto begin = chrono::steady_clock::now();
+    Distances distances(distanceMatrix, vertices);
+    vector<int> solution;
+
+    if (distanceMatrix == nullptr) {
+        solution = solveOnCoordinates(alg, vertices, size, deadline);
+    } else if (alg == "CHRISTOFIDES") {
+        solution = multiStartChristofides(distances, distanceMatrix, size, CONSTRUCTION_STARTS, 1, deadline)[0].first;
+    } else if (alg == "SIA") {
+        auto population = multiStartChristofides(distances, distanceMatrix, size, CONSTRUCTION_STARTS, SIA_POPULATION,
+                                                 deadline);
+        solution = siaAlgorithm(SIA_POPULATION, 3, population, distanceMatrix, deadline);
+    } else if (alg == "ACO") {
+        solution = antColonySolver(distanceMatrix, vertices, size, deadline);
+    } else if (alg == "SA") {
+        solution = multiStartChristofides(distances, distanceMatrix, size, CONSTRUCTION_STARTS, 1, deadline)[0].first;
+        solution = simulatedAnnealing(solution, distanceMatrix, size, deadline);
+    } else if (alg == "BNB") {
+        solution = branchNBound(distanceMatrix, size, deadline);
+    } else if (alg == "GREEDY") {
+        solution = greedyEdgeTour(distances, size);
+        solution = opt2Algorithm(solution, distanceMatrix, size, deadline);
+    } else if (alg == "HILBERT") {
+        solution = hilbertCurveTour(vertices);
+        solution = opt2Algorithm(solution, distanceMatrix, size, deadline);
+    } else if (alg == "CHEAPEST") {
+        solution = cheapestInsertion(distances, size);
+        solution = opt2Algorithm(solution, distanceMatrix, size, deadline);
+    } else if (alg == "FARTHEST") {
+        solution = farthestInsertion(distances, size);
+        solution = opt2Algorithm(solution, distanceMatrix, size, deadline);
+    } else {
+        cout << "Not valid ALGORITHM argument" << endl;
+        exit(1);
+    }
+    Solution result;
+    result.solution = solution;
+    result.distance = calculateTourDistance(solution, distances);
+    result.duration = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    return result;
+}
+
+/**
+ * Script tunning main algorithm with SIA on top of Christofides. Instances without distance matrix get construction
+ * in O(n log n) followed by neighbor list 2-opt, Christofides does not fit the time budget there.
+ *
+ * @param distanceMatrix DIstance matrix, nullptr for large instances
+ * @param vertices Coordinates of cities
+ * @param size Size of TSP tour
+ * @param deadline Time budget of the algorithm
+ * @return solution of named algorithm
+ */
+Solution runAlgorithm(int **distanceMatrix, const vector<Vertex> &vertices, int size, Deadline &deadline) {
+    TRACE_SCOPE("solve");
+    auto begin = chrono::steady_clock::now();
+    vector<int> solution;
+
+    if (distanceMatrix == nullptr) {
+        solution = solveOnCoordinates(size <= GREEDY_CITIES ? "GREEDY" : "HILBERT", vertices, size, deadline);
+    } else {
+        auto population = multiStartChristofides(Distances(distanceMatrix, vertices), distanceMatrix, size,
+                                                 CONSTRUCTION_STARTS, SIA_POPULATION, deadline);
+        /* 3 is clone size, -- aware of MAGIC CONSTANTS */
+        solution = siaAlgorithm(SIA_POPULATION, 3, population, distanceMatrix, deadline);
+    }
+    Solution result;
+    result.solution = solution;
+    result.distance = calculateTourDistance(solution, Distances(distanceMatrix, vertices));
+    result.duration = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    return result;
+}
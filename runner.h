@@ -0,0 +1,36 @@
+#ifndef TSP_FINAL_RUNNER_H
+#define TSP_FINAL_RUNNER_H
+
+#include <string>
+#include <vector>
+#include "graph.h"
+#include "deadline.h"
+
+using namespace std;
+
+/** Largest instance read with explicit distance matrix, larger instances are solved on coordinates only */
+const int MATRIX_CITIES = 5000;
+
+/**
+ * Encapsulation of Solution
+ */
+struct Solution {
+    vector<int> solution;
+    int distance;
+    double duration;
+    string instance;
+    string algorithm;
+};
+
+int **readFileInput(int *size, const string &file, vector<Vertex> &vertices);
+
+int **readInput(int *size, vector<Vertex> &vertices);
+
+bool solvesOnCoordinates(const string &alg);
+
+Solution runSpecific(const string &alg, int **distanceMatrix, const vector<Vertex> &vertices, int size,
+                     Deadline &deadline);
+
+Solution runAlgorithm(int **distanceMatrix, const vector<Vertex> &vertices, int size, Deadline &deadline);
+
+#endif //TSP_FINAL_RUNNER_H
@@ -0,0 +1,217 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include "graph.h"
+#include "instances.h"
+#include "kd_tree.h"
+#include "christofides.h"
+#include "opt2local.h"
+#include "deadline.h"
+
+using namespace std;
+
+/** Default smallest instance size, sizes double up to the largest one */
+const int DEFAULT_MIN_SIZE = 1000;
+/** Default largest instance size */
+const int DEFAULT_MAX_SIZE = 128000;
+/** Default largest size with distance matrix, matrix and 2-opt phases are skipped above it */
+const int DEFAULT_MATRIX_LIMIT = 10000;
+/** Candidates per city, same as Christofides spanning tree uses */
+const int SCALING_CANDIDATES = 10;
+/** Phases shorter than this give no growth exponent, they are dominated by noise */
+const double MIN_EXPONENT_TIME = 0.001;
+
+/**
+ * Options of scaling study.
+ */
+struct ScalingOptions {
+    InstanceKind kind = UNIFORM_INSTANCE;
+    string kindName = "uniform";
+    int minSize = DEFAULT_MIN_SIZE;
+    int maxSize = DEFAULT_MAX_SIZE;
+    int matrixLimit = DEFAULT_MATRIX_LIMIT;
+    unsigned long seed = 1;
+    bool csv = false;
+};
+
+/**
+ * Reads value of memory field from /proc/self/status.
+ *
+ * @param field Name of field, VmRSS or VmHWM
+ * @return Value in kilobytes, 0 if not available
+ */
+long statusKilobytes(const string &field) {
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.compare(0, field.size() + 1, field + ":") == 0) {
+            return atol(line.c_str() + field.size() + 1);
+        }
+    }
+    return 0;
+}
+
+/**
+ * Resets peak resident memory of the process to its current resident memory, so peak of next phase can be read.
+ */
+void resetPeakMemory() {
+    ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+}
+
+/**
+ * Runs one phase, prints its time and memory on top of memory held before it, and growth exponent of its time
+ * against previous size.
+ *
+ * @param options Options of scaling study
+ * @param size Instance size
+ * @param phase Name of phase
+ * @param previous Time of every phase at previous size, updated with time of this phase
+ * @param body Phase
+ */
+void runPhase(const ScalingOptions &options, int size, const string &phase, map<string, double> &previous,
+              const function<void()> &body) {
+    resetPeakMemory();
+    long before = statusKilobytes("VmRSS");
+    auto begin = chrono::steady_clock::now();
+    body();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    long memory = max(0L, statusKilobytes("VmHWM") - before);
+
+    string exponent;
+    auto last = previous.find(phase);
+    if (last != previous.end() && last->second >= MIN_EXPONENT_TIME && seconds >= MIN_EXPONENT_TIME) {
+        ostringstream value;
+        value << fixed << setprecision(2) << log(seconds / last->second) / log(2.0);
+        exponent = value.str();
+    }
+    previous[phase] = seconds;
+
+    if (options.csv) {
+        cout << options.kindName << "," << size << "," << phase << "," << seconds << "," << memory << ","
+             << exponent << endl;
+    } else {
+        cout << left << setw(12) << options.kindName << right << setw(10) << size << "  " << left << setw(14)
+             << phase << right << setw(12) << fixed << setprecision(4) << seconds << setw(14) << memory << setw(10)
+             << exponent << defaultfloat << endl;
+    }
+}
+
+/**
+ * Runs all phases on one generated instance: reading it in text and binary format, building distance matrix,
+ * candidate lists with k-d tree, Christofides construction on coordinates and one 2-opt pass over the matrix.
+ *
+ * @param options Options of scaling study
+ * @param size Instance size
+ * @param previous Time of every phase at previous size
+ */
+void studySize(const ScalingOptions &options, int size, map<string, double> &previous) {
+    vector<Vertex> generated = generateInstance(options.kind, size, options.seed);
+    string text = "scaling_" + to_string(size) + ".tsp", binary = "scaling_" + to_string(size) + ".bin";
+    writeTextInstance(text, generated);
+    writeBinaryInstance(binary, generated);
+    generated = vector<Vertex>();
+
+    vector<Vertex> vertices;
+    runPhase(options, size, "read_text", previous, [&]() {
+        readTextInstance(text, vertices);
+    });
+    vertices.clear();
+    runPhase(options, size, "read_binary", previous, [&]() {
+        readBinaryInstance(binary, vertices);
+    });
+    remove(text.c_str());
+    remove(binary.c_str());
+
+    int **distanceMatrix = nullptr;
+    if (size <= options.matrixLimit) {
+        runPhase(options, size, "matrix", previous, [&]() {
+            distanceMatrix = createDistanceMatrix(vertices);
+        });
+    }
+    runPhase(options, size, "candidates", previous, [&]() {
+        KdTree tree(vertices);
+        tree.allNearest(SCALING_CANDIDATES);
+    });
+    vector<int> tour;
+    runPhase(options, size, "construction", previous, [&]() {
+        tour = christofidesAlgorithm(Distances(vertices), size);
+    });
+    if (distanceMatrix != nullptr) {
+        Deadline unlimited;
+        runPhase(options, size, "local_search", previous, [&]() {
+            tour.push_back(tour[0]);
+            opt2Pass(tour, distanceMatrix, size, unlimited);
+            tour.pop_back();
+        });
+        deleteDistanceMatrix(distanceMatrix, size);
+    }
+}
+
+/**
+ * Parses command line options.
+ *
+ * @param argc Number of arguments
+ * @param argv Arguments
+ * @param options Parsed options
+ * @return False if options are invalid
+ */
+bool parseScalingOptions(int argc, char *argv[], ScalingOptions &options) {
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--csv") {
+            options.csv = true;
+            continue;
+        }
+        if (i + 1 >= argc) return false;
+        string value = argv[++i];
+        if (option == "--kind") {
+            options.kindName = value;
+            if (!parseInstanceKind(value, &options.kind)) return false;
+        } else if (option == "--min") {
+            options.minSize = atoi(value.c_str());
+        } else if (option == "--max") {
+            options.maxSize = atoi(value.c_str());
+        } else if (option == "--matrix-limit") {
+            options.matrixLimit = atoi(value.c_str());
+        } else if (option == "--seed") {
+            options.seed = strtoul(value.c_str(), nullptr, 10);
+        } else {
+            return false;
+        }
+    }
+    return options.minSize >= 4 && options.maxSize >= options.minSize;
+}
+
+/**
+ * Scaling study of solver phases on generated instances with doubling size. Exponent column is growth of phase time
+ * between consecutive sizes, 1 for linear phase and 2 for quadratic one.
+ */
+int main(int argc, char *argv[]) {
+    ScalingOptions options;
+    if (!parseScalingOptions(argc, argv, options)) {
+        cerr << "Usage: scaling_study [--kind uniform|clustered|grid] [--min <n>] [--max <n>] [--matrix-limit <n>] "
+                "[--seed <n>] [--csv]" << endl;
+        return 2;
+    }
+    if (options.csv) {
+        cout << "kind,size,phase,seconds,memory_kb,exponent" << endl;
+    } else {
+        cout << left << setw(12) << "kind" << right << setw(10) << "size" << "  " << left << setw(14) << "phase"
+             << right << setw(12) << "seconds" << setw(14) << "memory_kb" << setw(10) << "exponent" << endl;
+    }
+    map<string, double> previous;
+    for (long size = options.minSize; size <= options.maxSize; size *= 2) {
+        studySize(options, (int) size, previous);
+    }
+    return 0;
+}
@@ -1,10 +1,13 @@
 #include <vector>
 #include <algorithm>
 #include "iostream"
-#include <ctime>
 #include "opt2local.h"
 #include "graph.h"
 #include "random_provider.h"
+#include "deadline.h"
+#include "sia.h"
+#include "counters.h"
+#include "trace.h"
 
 using namespace std;
 
@@ -16,9 +19,11 @@ typedef pair<vector<int>, int> Individual;
  *
  * @param solution Current cycle
  * @param dm Distance matrix
+ * @param noSwitches Number of vertices rotated between their positions
+ * @param deadline Time budget for Opt2 optimization
  * @return Neighbor created by switching two vertices and doing Opt2
  */
-Individual createNeighbor(vector<int> solution, int **dm, int noSwitches) {
+Individual createNeighbor(vector<int> solution, int **dm, int noSwitches, Deadline &deadline) {
     vector<int> v(solution.size());
     vector<int> switched;
     for (int i = 0; i < noSwitches; i++) {
@@ -43,7 +48,7 @@ Individual createNeighbor(vector<int> solution, int **dm, int noSwitches) {
             v[i] = solution[i];
         }
     }
-    v = opt2Algorithm(v, dm, (int) v.size());
+    v = opt2Algorithm(v, dm, (int) v.size(), deadline);
     return make_pair(v, calculateTourDistance(v, dm));
 }
 
@@ -53,12 +58,14 @@ Individual createNeighbor(vector<int> solution, int **dm, int noSwitches) {
  * @param solution First solution, obtained by some construction algorithm
  * @param popSize Size of population in SIA
  * @param dm Distance matrix
+ * @param deadline Time budget
  * @return Vector representing current population
  */
-vector<Individual> initializeSolutions(const vector<int> &solution, int popSize, int **dm) {
+vector<Individual> initializeSolutions(const vector<int> &solution, int popSize, int **dm, Deadline &deadline) {
     auto population = vector<Individual>();
     for (int i = 0; i < popSize; ++i) {
-        population.push_back(createNeighbor(solution, dm, 2));
+        if (deadline.expired()) break;
+        population.push_back(createNeighbor(solution, dm, 2, deadline));
     }
     return population;
 }
@@ -80,15 +87,18 @@ bool sortByDistance(const Individual &a, const Individual &b) {
  *
  * @param population Current population in algorithm
  * @param dm  Distance matrix
+ * @param deadline Time budget, cloning stops when it expires
  * @return Vector of cloned population
  */
-vector<Individual> clone(vector<Individual> population, int mBest, int **dm) {
+vector<Individual> clone(vector<Individual> population, int mBest, int **dm, Deadline &deadline) {
     vector<Individual> newPopulation = vector<Individual>();
     newPopulation.push_back(population[0]);
     for (int i = 0; i < mBest; ++i) {
         int switches = 2;
         for (int j = 0, n = (int) (population.size() / mBest); j < n; ++j) {
-            newPopulation.push_back(createNeighbor(population[i].first, dm, switches));
+            if (deadline.expired()) return newPopulation;
+            newPopulation.push_back(createNeighbor(population[i].first, dm, switches, deadline));
+            COUNT(SIA_CLONES, 1);
         }
     }
     return newPopulation;
@@ -97,23 +107,43 @@ vector<Individual> clone(vector<Individual> population, int mBest, int **dm) {
 /**
  * Core of SIA, firstly population is created to contain DNA of first solution, then it is sorted by best solution,
  * and first n best are cloned and mutated to create next population. This algorithm is elitistic since best individual
- * is always preserved. Algorithm runs till 2s deadline is reached.
+ * is always preserved. Algorithm runs till deadline is reached.
  *
- * @param begin Algorithm's starting time
  * @param solution Solution that carries DNA of first population
  * @param dm Distance matrix
+ * @param deadline Time budget of the algorithm
  * @return Best tour obtained in algorithm
  */
-vector<int> siaAlgorithm(int populationSize, int cloneN, const vector<int> &solution, int **dm, clock_t begin) {
-    auto population = initializeSolutions(solution, populationSize, dm);
+vector<int> siaAlgorithm(int populationSize, int cloneN, const vector<int> &solution, int **dm, Deadline &deadline) {
+    auto population = initializeSolutions(solution, populationSize, dm, deadline);
+    population.emplace_back(solution, calculateTourDistance(solution, dm));
+    return siaAlgorithm(populationSize, cloneN, population, dm, deadline);
+}
+
+/**
+ * SIA started from provided population, for example best tours of multi-start construction.
+ *
+ * @param population First population, must not be empty
+ * @param dm Distance matrix
+ * @param deadline Time budget of the algorithm
+ * @return Best tour obtained in algorithm
+ */
+vector<int> siaAlgorithm(int populationSize, int cloneN, vector<Individual> population, int **dm, Deadline &deadline) {
+    PHASE_TIMER(SIA_TIMER);
+    // Small population is completed with neighbors of its members
+    for (int i = 0; (int) population.size() < populationSize && !deadline.expired(); ++i) {
+        population.push_back(createNeighbor(population[i].first, dm, 2, deadline));
+    }
     sort(population.begin(), population.end(), sortByDistance);
+    if ((int) population.size() > populationSize) population.resize(static_cast<unsigned long>(populationSize));
     int iter = 0;
-    while (true) {
-        if ((double(clock() - begin) / CLOCKS_PER_SEC) >= 1.9) break;
-        population = clone(population, cloneN, dm);
+    while (!deadline.expired()) {
+        TRACE_SCOPE("sia_generation");
+        population = clone(population, cloneN, dm, deadline);
         sort(population.begin(), population.end(), sortByDistance);
-        population.resize(static_cast<unsigned long>(populationSize));
+        if ((int) population.size() > populationSize) population.resize(static_cast<unsigned long>(populationSize));
         iter++;
+        COUNT(SIA_GENERATIONS, 1);
     }
     return population[0].first;
 }
@@ -10,20 +10,23 @@
 #include <algorithm>
 #include "opt2local.h"
 #include "graph.h"
+#include "deadline.h"
 
 using namespace std;
 
 
 typedef pair<vector<int>, int> Individual;
 
-Individual createNeighbor(vector<int> solution, int **dm);
+Individual createNeighbor(vector<int> solution, int **dm, int noSwitches, Deadline &deadline);
 
-vector<Individual> initializeSolutions(const vector<int> &solution, int popSize, int **dm);
+vector<Individual> initializeSolutions(const vector<int> &solution, int popSize, int **dm, Deadline &deadline);
 
 bool sortByDistance(const Individual &a, const Individual &b);
 
-vector<Individual> clone(vector<Individual> population, int **dm);
+vector<Individual> clone(vector<Individual> population, int mBest, int **dm, Deadline &deadline);
 
-vector<int> siaAlgorithm(int populationSize, int cloneN, const vector<int> &solution, int **dm, clock_t begin);
+vector<int> siaAlgorithm(int populationSize, int cloneN, const vector<int> &solution, int **dm, Deadline &deadline);
+
+vector<int> siaAlgorithm(int populationSize, int cloneN, vector<Individual> population, int **dm, Deadline &deadline);
 
 #endif //TSP_FINAL_CLONALG_H
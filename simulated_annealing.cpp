@@ -2,6 +2,9 @@
 #include "random_provider.h"
 #include "opt2local.h"
 #include "graph.h"
+#include "deadline.h"
+#include "counters.h"
+#include "trace.h"
 
 /**
  * Class that can create neighbor of a solution, by switching cities
@@ -54,19 +57,24 @@ double GeometricTempSchedule::getNextTemperature() {
 /**
  * Runs through 2 loops, the outer lowers the temperature while the inner creates neighbors.
  * If the solution has better fitness (lower cost), it becomes the current solution, but if it doesn't,
- * there is still a probability based on the temperature that it will be chosen.
+ * there is still a probability based on the temperature that it will be chosen. Stops early when deadline expires.
+ *
+ * @param deadline Time budget of the algorithm
  */
-void SimulatedAnnealing::run() {
+void SimulatedAnnealing::run(Deadline &deadline) {
+    PHASE_TIMER(SA_TIMER);
     vector<int> solution = startWith;
     vector<int> globalBest = startWith;
 
     int globalFitness = calculateTourDistance(globalBest, distanceMatrix);
 
-    for (int i = 0, outerLoop = tempSchedule.outerLimit; i < outerLoop; i++) {
+    for (int i = 0, outerLoop = tempSchedule.outerLimit; i < outerLoop && !deadline.expired(); i++) {
+        TRACE_SCOPE("sa_temperature");
         //Lowers the temperature
         double temperature = tempSchedule.getNextTemperature();
 
         for (int j = 0, innerLoop = tempSchedule.innerLimit; j < innerLoop; j++) {
+            if (deadline.expired()) break;
 
             int n1 = iRand(0, (unsigned long) size - 1);
             int n2 = iRand(0, (unsigned long) size - 1);
@@ -80,15 +88,19 @@ void SimulatedAnnealing::run() {
             //int neighborFitness = calculateNeighborFitness(solution, neighbor, n1, n2, solutionFitness, (int)size, distanceMatrix);
 
             int deltaEnergy = neighborFitness - solutionFitness;
+            COUNT(SA_MOVES, 1);
 
             //Assigns the current solution if better or with certain probability
             if (deltaEnergy <= 0) {
                 solution = neighbor;
                 solutionFitness = neighborFitness;
+                COUNT(SA_ACCEPTED, 1);
 
             } else if (fRand() <= exp(-deltaEnergy / temperature)) {
                 solution = neighbor;
                 solutionFitness = neighborFitness;
+                COUNT(SA_ACCEPTED, 1);
+                COUNT(SA_UPHILL_ACCEPTED, 1);
             }
 
             if (solutionFitness <= globalFitness) {
@@ -97,7 +109,7 @@ void SimulatedAnnealing::run() {
             }
         }
 
-        solution = opt2Algorithm(solution, distanceMatrix, size);
+        solution = opt2Algorithm(solution, distanceMatrix, size, deadline);
         int solutionFitness = calculateTourDistance(solution, distanceMatrix);
 
         //Update global best if you found it
@@ -117,15 +129,16 @@ void SimulatedAnnealing::run() {
  * @param startSolution Starting solution in algorithm
  * @param distanceMatrix Distance matrix
  * @param size Size of tsp instance
+ * @param deadline Time budget of the algorithm
  * @return
  */
-vector<int> simulatedAnnealing(vector<int> &startSolution, int **distanceMatrix, int size) {
+vector<int> simulatedAnnealing(vector<int> &startSolution, int **distanceMatrix, int size, Deadline &deadline) {
     //alpha, initial, inner, outer
     GeometricTempSchedule tempSchedule(0.98, 100, 0.001, 100, 500);
     Neighborhood neighborhood;
 
     SimulatedAnnealing s(startSolution, tempSchedule, neighborhood, distanceMatrix, size);
-    s.run();
+    s.run(deadline);
 
     vector<int> best = s.best;
 
@@ -2,6 +2,7 @@
 #define TSP_FINAL_SIMULATED_ANNEALING_H
 
 #include "vector"
+#include "deadline.h"
 
 using namespace std;
 
@@ -63,9 +64,9 @@ public:
                        int size) : startWith(startWith), tempSchedule(tempSchedule), neighborhood(neighborhood),
                                    distanceMatrix(distanceMatrix), size(size) {};
 
-    void run();
+    void run(Deadline &deadline);
 };
 
-vector<int> simulatedAnnealing(vector<int> &startSolution, int **distanceMatrix, int size);
+vector<int> simulatedAnnealing(vector<int> &startSolution, int **distanceMatrix, int size, Deadline &deadline);
 
 #endif
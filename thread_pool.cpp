@@ -0,0 +1,126 @@
+#include <thread>
+#include <cstdlib>
+#include "thread_pool.h"
+
+using namespace std;
+
+/** True while current thread executes a pool task, nested parallel loops then run inline. */
+thread_local bool insideTask = false;
+
+/**
+ * Creates pool with given number of workers, including the calling thread.
+ *
+ * @param workers Number of workers
+ */
+ThreadPool::ThreadPool(int workers) : next(0) {
+    for (int i = 1; i < workers; i++) {
+        threads.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (thread &t : threads) {
+        t.join();
+    }
+}
+
+/**
+ * @return Number of workers, worker indices passed to tasks are smaller than this
+ */
+int ThreadPool::size() const {
+    return (int) threads.size() + 1;
+}
+
+/**
+ * Runs body for every task index from 0 to count - 1 and waits for all of them to finish. Body receives task index
+ * and index of worker running it, so it can use per-worker scratch memory. Called from inside a task or while pool
+ * is busy with another loop, tasks are run inline by the calling thread as worker 0.
+ *
+ * @param count Number of tasks
+ * @param body Task body taking task index and worker index
+ */
+void ThreadPool::parallelFor(int count, const function<void(int, int)> &body) {
+    unique_lock<mutex> exclusive(running, try_to_lock);
+    if (!exclusive.owns_lock() || insideTask || threads.empty() || count <= 1) {
+        for (int i = 0; i < count; i++) {
+            body(i, 0);
+        }
+        return;
+    }
+
+    {
+        lock_guard<mutex> guard(lock);
+        task = &body;
+        taskCount = count;
+        next.store(0);
+        pending = (int) threads.size();
+        generation++;
+    }
+    wake.notify_all();
+    runTasks(0);
+
+    unique_lock<mutex> guard(lock);
+    done.wait(guard, [this] { return pending == 0; });
+    task = nullptr;
+}
+
+/**
+ * Loop of worker thread, waits for new parallel loop and takes part in it.
+ *
+ * @param worker Index of worker
+ */
+void ThreadPool::work(int worker) {
+    unsigned long seen = 0;
+    while (true) {
+        {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [this, seen] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        runTasks(worker);
+        {
+            lock_guard<mutex> guard(lock);
+            if (--pending == 0) done.notify_one();
+        }
+    }
+}
+
+/**
+ * Takes tasks of current loop one by one until none is left.
+ *
+ * @param worker Index of worker
+ */
+void ThreadPool::runTasks(int worker) {
+    insideTask = true;
+    for (int i = next.fetch_add(1); i < taskCount; i = next.fetch_add(1)) {
+        (*task)(i, worker);
+    }
+    insideTask = false;
+}
+
+/**
+ * Number of workers of shared pool, TSP_THREADS environment variable if set, number of hardware threads otherwise.
+ *
+ * @return Number of workers
+ */
+int defaultWorkers() {
+    const char *threads = getenv("TSP_THREADS");
+    if (threads != nullptr && atoi(threads) > 0) return atoi(threads);
+    return thread::hardware_concurrency() > 0 ? (int) thread::hardware_concurrency() : 1;
+}
+
+/**
+ * Pool shared by all solvers.
+ *
+ * @return Shared thread pool
+ */
+ThreadPool &sharedThreadPool() {
+    static ThreadPool pool(defaultWorkers());
+    return pool;
+}
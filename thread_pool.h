@@ -0,0 +1,47 @@
+#ifndef TSP_FINAL_THREAD_POOL_H
+#define TSP_FINAL_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Fixed pool of worker threads used by solvers to run independent tasks (ants, restarts, starting cities)
+ * concurrently. Calling thread takes part in the work as worker 0, so pool of size 1 runs everything inline.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(int workers);
+
+    ~ThreadPool();
+
+    int size() const;
+
+    void parallelFor(int count, const function<void(int, int)> &body);
+
+private:
+    void work(int worker);
+
+    void runTasks(int worker);
+
+    vector<thread> threads;
+    mutex running;
+    mutex lock;
+    condition_variable wake;
+    condition_variable done;
+    const function<void(int, int)> *task = nullptr;
+    int taskCount = 0;
+    atomic<int> next;
+    int pending = 0;
+    unsigned long generation = 0;
+    bool stopping = false;
+};
+
+ThreadPool &sharedThreadPool();
+
+#endif //TSP_FINAL_THREAD_POOL_H
@@ -0,0 +1,138 @@
+#include <fstream>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <cstdlib>
+#include "trace.h"
+
+using namespace std;
+
+/**
+ * Begin or end event of a phase, name must be a string literal.
+ */
+struct TraceEvent {
+    const char *name;
+    long timestamp;
+    char phase;
+};
+
+/**
+ * Ring of events of one thread. Only its own thread writes events, count of written events is published with release
+ * store so the ring can be read from other thread without locking.
+ */
+struct TraceBuffer {
+    int thread;
+    vector<TraceEvent> events;
+    atomic<unsigned long> written;
+
+    explicit TraceBuffer(int thread) : thread(thread), events(TRACE_BUFFER_EVENTS), written(0) {}
+};
+
+/** Set while events are recorded */
+atomic<bool> tracing(false);
+/** Number of threads writing an event at the moment, trace is written only after it drops to zero */
+atomic<int> writers(0);
+/** Time of trace start, timestamps are measured from it */
+chrono::steady_clock::time_point traceStart;
+/** File the trace is written to */
+string traceFile;
+/** Rings of all threads which recorded an event, kept after their threads exit */
+mutex traceMutex;
+vector<unique_ptr<TraceBuffer>> traceBuffers;
+
+/**
+ * Ring of current thread, registered on its first event.
+ *
+ * @return Trace buffer of current thread
+ */
+TraceBuffer &threadTraceBuffer() {
+    thread_local TraceBuffer *buffer = nullptr;
+    if (buffer == nullptr) {
+        lock_guard<mutex> lock(traceMutex);
+        traceBuffers.emplace_back(new TraceBuffer((int) traceBuffers.size()));
+        buffer = traceBuffers.back().get();
+    }
+    return *buffer;
+}
+
+/**
+ * Starts recording events, trace is written to file when program exits. Has to be called from the main thread, its
+ * ring is registered first so it is labeled as main even when a worker records the first event.
+ *
+ * @param file Path of Chrome trace JSON file
+ */
+void startTrace(const string &file) {
+    traceFile = file;
+    threadTraceBuffer();
+    traceStart = chrono::steady_clock::now();
+    tracing.store(true);
+    atexit(writeTrace);
+}
+
+/**
+ * Records event on the ring of current thread.
+ *
+ * @param name Name of phase, string literal
+ * @param phase 'B' for begin and 'E' for end of phase
+ * @return False if tracing is not started and nothing was recorded
+ */
+bool traceEvent(const char *name, char phase) {
+    if (!tracing.load(memory_order_relaxed)) return false;
+    writers.fetch_add(1);
+    if (!tracing.load()) {
+        writers.fetch_sub(1);
+        return false;
+    }
+    TraceBuffer &buffer = threadTraceBuffer();
+    unsigned long index = buffer.written.load(memory_order_relaxed);
+    TraceEvent &event = buffer.events[index % TRACE_BUFFER_EVENTS];
+    event.name = name;
+    event.timestamp = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - traceStart).count();
+    event.phase = phase;
+    buffer.written.store(index + 1, memory_order_release);
+    writers.fetch_sub(1, memory_order_release);
+    return true;
+}
+
+/**
+ * Stops recording and writes events of all threads as Chrome trace JSON, readable by chrome://tracing and Perfetto.
+ * Workers of thread pool may still run when program exits, so rings are read only after every event being written
+ * was finished, later events are not recorded. When a ring was overwritten, end events whose begin event was lost are
+ * left out.
+ */
+void writeTrace() {
+    if (!tracing.exchange(false)) return;
+    while (writers.load(memory_order_acquire) != 0) {
+        this_thread::yield();
+    }
+    lock_guard<mutex> lock(traceMutex);
+    ofstream f(traceFile);
+    f << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << endl;
+    bool first = true;
+    for (auto &buffer : traceBuffers) {
+        f << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->thread
+          << ",\"args\":{\"name\":\"" << (buffer->thread == 0 ? "main" : "worker " + to_string(buffer->thread))
+          << "\"}}";
+        first = false;
+
+        unsigned long written = buffer->written.load(memory_order_acquire);
+        unsigned long begin = written > TRACE_BUFFER_EVENTS ? written - TRACE_BUFFER_EVENTS : 0;
+        int depth = 0;
+        for (unsigned long i = begin; i < written; i++) {
+            const TraceEvent &event = buffer->events[i % TRACE_BUFFER_EVENTS];
+            if (event.phase == 'E') {
+                if (depth == 0) continue;
+                depth--;
+            } else {
+                depth++;
+            }
+            f << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase << "\",\"ts\":"
+              << event.timestamp / 1000 << "." << event.timestamp / 100 % 10 << event.timestamp / 10 % 10
+              << event.timestamp % 10 << ",\"pid\":1,\"tid\":" << buffer->thread << "}";
+        }
+    }
+    f << endl << "]}" << endl;
+}
@@ -0,0 +1,42 @@
+#ifndef TSP_FINAL_TRACE_H
+#define TSP_FINAL_TRACE_H
+
+#include <string>
+
+using namespace std;
+
+/** Number of events kept per thread, oldest events are overwritten once the ring is full */
+const unsigned long TRACE_BUFFER_EVENTS = 1 << 18;
+
+void startTrace(const string &file);
+
+bool traceEvent(const char *name, char phase);
+
+void writeTrace();
+
+/**
+ * Records begin event of a named phase when created and its end event when destroyed, both on the calling thread.
+ * Costs a single atomic load when tracing is not started.
+ */
+class TraceScope {
+public:
+    explicit TraceScope(const char *name) : name(name), active(traceEvent(name, 'B')) {}
+
+    TraceScope(const TraceScope &) = delete;
+
+    TraceScope &operator=(const TraceScope &) = delete;
+
+    ~TraceScope() {
+        if (active) traceEvent(name, 'E');
+    }
+
+private:
+    const char *name;
+    bool active;
+};
+
+#define TSP_TRACE_JOIN(a, b) a##b
+#define TSP_TRACE_NAME(a, b) TSP_TRACE_JOIN(a, b)
+#define TRACE_SCOPE(name) TraceScope TSP_TRACE_NAME(traceScope, __LINE__)(name)
+
+#endif //TSP_FINAL_TRACE_H
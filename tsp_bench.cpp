@@ -0,0 +1,422 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <dirent.h>
+#include "graph.h"
+#include "runner.h"
+#include "deadline.h"
+#include "random_provider.h"
+
+using namespace std;
+
+/** Default wall-clock time budget of one run in seconds, same as in main program */
+const double DEFAULT_TIME_LIMIT = 1.9;
+/** Default number of runs of every algorithm on every instance */
+const int DEFAULT_RUNS = 5;
+/** Default seed of first run, run i uses seed + i */
+const unsigned long DEFAULT_SEED = 1;
+/** Default allowed increase of median time and median length in compare mode, in percent */
+const double DEFAULT_TOLERANCE = 10;
+/** Median times shorter than this in both runs are not compared, they are dominated by noise */
+const double MIN_COMPARED_TIME = 0.01;
+
+/** Lengths of optimal tours of sample instances, with distances rounded to closest integer */
+const map<string, int> KNOWN_OPTIMA = {
+        {"n10",      2826},
+        {"berlin52", 7542},
+        {"ch130",    6110},
+        {"a280",     2579},
+        {"pr439",    107217}
+};
+
+/** All algorithm codes of runSpecific */
+const vector<string> ALL_ALGORITHMS = {"CHRISTOFIDES", "SIA", "ACO", "SA", "BNB", "GREEDY", "HILBERT", "CHEAPEST",
+                                       "FARTHEST"};
+
+/**
+ * Options of the benchmark, see printUsage.
+ */
+struct BenchOptions {
+    vector<string> instances;
+    vector<string> algorithms = ALL_ALGORITHMS;
+    int runs = DEFAULT_RUNS;
+    unsigned long seed = DEFAULT_SEED;
+    double timeLimit = DEFAULT_TIME_LIMIT;
+    string format = "json";
+    string output;
+    string baseline;
+    double tolerance = DEFAULT_TOLERANCE;
+    int maxCities = MATRIX_CITIES;
+};
+
+/**
+ * Minimum, median and 95th percentile of measured values.
+ */
+struct Summary {
+    double min = 0;
+    double median = 0;
+    double p95 = 0;
+};
+
+/**
+ * Measurements of one algorithm on one instance.
+ */
+struct BenchResult {
+    string instance;
+    string algorithm;
+    int size = 0;
+    int runs = 0;
+    /** Length of optimal tour, 0 if not known */
+    int optimum = 0;
+    Summary time;
+    Summary length;
+    /** Gap of tour length to optimum in percent, only if optimum is known */
+    Summary gap;
+};
+
+/**
+ * Summarizes values with nearest-rank percentiles.
+ *
+ * @param values Measured values
+ * @return Summary of values
+ */
+Summary summarize(vector<double> values) {
+    Summary summary;
+    if (values.empty()) return summary;
+    sort(values.begin(), values.end());
+    int n = (int) values.size();
+    summary.min = values[0];
+    summary.median = n % 2 == 1 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+    summary.p95 = values[max(0, (int) ceil(0.95 * n) - 1)];
+    return summary;
+}
+
+/**
+ * Splits text by separator.
+ *
+ * @param text Text to split
+ * @param separator Separator of parts
+ * @return Parts of text, empty ones included
+ */
+vector<string> split(const string &text, char separator) {
+    vector<string> parts;
+    istringstream stream(text);
+    string part;
+    while (getline(stream, part, separator)) {
+        parts.push_back(part);
+    }
+    return parts;
+}
+
+/**
+ * Names of all instances in samples directory, in text or binary format, sorted.
+ *
+ * @return Instance names without extension
+ */
+vector<string> sampleInstances() {
+    vector<string> instances;
+    DIR *directory = opendir("./samples");
+    if (directory == nullptr) return instances;
+    while (dirent *entry = readdir(directory)) {
+        string name = entry->d_name;
+        if (name.size() > 4 && (name.compare(name.size() - 4, 4, ".tsp") == 0 ||
+                                name.compare(name.size() - 4, 4, ".bin") == 0)) {
+            instances.push_back(name.substr(0, name.size() - 4));
+        }
+    }
+    closedir(directory);
+    sort(instances.begin(), instances.end());
+    instances.erase(unique(instances.begin(), instances.end()), instances.end());
+    return instances;
+}
+
+/**
+ * Runs every algorithm on instance with fixed seeds. Global random generator is seeded before every run, so run i
+ * of every algorithm starts from seed + i.
+ *
+ * @param instance Name of instance in samples directory
+ * @param options Options of the benchmark
+ * @param results Vector receiving one result per algorithm
+ */
+void benchInstance(const string &instance, const BenchOptions &options, vector<BenchResult> &results) {
+    int size;
+    vector<Vertex> vertices;
+    int **distanceMatrix = readFileInput(&size, instance, vertices);
+    if (size <= 3) {
+        cerr << "Skipping " << instance << ", it has only " << size << " cities" << endl;
+    } else if (size > options.maxCities) {
+        cerr << "Skipping " << instance << ", it has " << size << " cities, more than --max-cities" << endl;
+    }
+
+    for (const string &algorithm : options.algorithms) {
+        if (size <= 3 || size > options.maxCities) break;
+        if (distanceMatrix == nullptr && !solvesOnCoordinates(algorithm)) {
+            cerr << "Skipping " << algorithm << " on " << instance << ", it needs distance matrix" << endl;
+            continue;
+        }
+        BenchResult result;
+        result.instance = instance;
+        result.algorithm = algorithm;
+        result.size = size;
+        result.runs = options.runs;
+        auto optimum = KNOWN_OPTIMA.find(instance);
+        result.optimum = optimum == KNOWN_OPTIMA.end() ? 0 : optimum->second;
+
+        vector<double> times, lengths, gaps;
+        for (int run = 0; run < options.runs; run++) {
+            seedRandom(options.seed + run);
+            Deadline deadline(options.timeLimit);
+            Solution solution = runSpecific(algorithm, distanceMatrix, vertices, size, deadline);
+            times.push_back(solution.duration);
+            lengths.push_back(solution.distance);
+            if (result.optimum > 0) gaps.push_back(100.0 * (solution.distance - result.optimum) / result.optimum);
+        }
+        result.time = summarize(times);
+        result.length = summarize(lengths);
+        result.gap = summarize(gaps);
+        results.push_back(result);
+        cerr << instance << " " << algorithm << " median " << result.time.median << "s " << result.length.median
+             << endl;
+    }
+
+    deleteDistanceMatrix(distanceMatrix, size);
+}
+
+/**
+ * Writes summary as JSON object.
+ *
+ * @param out Output stream
+ * @param summary Summary to write
+ */
+void writeJsonSummary(ostream &out, const Summary &summary) {
+    out << "{\"min\": " << summary.min << ", \"median\": " << summary.median << ", \"p95\": " << summary.p95 << "}";
+}
+
+/**
+ * Writes results as JSON document with options of the benchmark and one object per algorithm and instance.
+ *
+ * @param out Output stream
+ * @param options Options of the benchmark
+ * @param results Results of the benchmark
+ */
+void writeJson(ostream &out, const BenchOptions &options, const vector<BenchResult> &results) {
+    out << "{\n  \"runs\": " << options.runs << ",\n  \"seed\": " << options.seed << ",\n  \"timeLimit\": "
+        << options.timeLimit << ",\n  \"results\": [";
+    for (int i = 0; i < (int) results.size(); i++) {
+        const BenchResult &result = results[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\"instance\": \"" << result.instance << "\", \"algorithm\": \""
+            << result.algorithm << "\", \"size\": " << result.size << ", \"runs\": " << result.runs;
+        out << ",\n     \"time\": ";
+        writeJsonSummary(out, result.time);
+        out << ",\n     \"length\": ";
+        writeJsonSummary(out, result.length);
+        if (result.optimum > 0) {
+            out << ",\n     \"optimum\": " << result.optimum << ", \"gap\": ";
+            writeJsonSummary(out, result.gap);
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}" << endl;
+}
+
+/**
+ * Writes results as CSV with header, one row per algorithm and instance. Gap columns are empty when optimum is not
+ * known. Files written this way are baselines for compare mode.
+ *
+ * @param out Output stream
+ * @param results Results of the benchmark
+ */
+void writeCsv(ostream &out, const vector<BenchResult> &results) {
+    out << "instance,algorithm,size,runs,time_min,time_median,time_p95,length_min,length_median,length_p95,optimum,"
+           "gap_min,gap_median,gap_p95" << endl;
+    for (const BenchResult &result : results) {
+        out << result.instance << "," << result.algorithm << "," << result.size << "," << result.runs << ","
+            << result.time.min << "," << result.time.median << "," << result.time.p95 << ","
+            << result.length.min << "," << result.length.median << "," << result.length.p95 << ",";
+        if (result.optimum > 0) {
+            out << result.optimum << "," << result.gap.min << "," << result.gap.median << "," << result.gap.p95;
+        } else {
+            out << ",,,";
+        }
+        out << endl;
+    }
+}
+
+/**
+ * Reads baseline written in CSV format.
+ *
+ * @param file Path of baseline
+ * @param baseline Map from instance and algorithm to their result
+ * @return False if file can not be read
+ */
+bool readBaseline(const string &file, map<pair<string, string>, BenchResult> &baseline) {
+    ifstream input(file);
+    if (!input) return false;
+    string line;
+    getline(input, line);
+    while (getline(input, line)) {
+        vector<string> columns = split(line, ',');
+        if (columns.size() < 10) continue;
+        BenchResult result;
+        result.instance = columns[0];
+        result.algorithm = columns[1];
+        result.time.median = stod(columns[5]);
+        result.length.median = stod(columns[8]);
+        baseline[make_pair(result.instance, result.algorithm)] = result;
+    }
+    return true;
+}
+
+/**
+ * Percentual change from baseline value.
+ *
+ * @param before Baseline value
+ * @param after New value
+ * @return Change in percent
+ */
+double change(double before, double after) {
+    return before == 0 ? 0 : 100.0 * (after - before) / before;
+}
+
+/**
+ * Compares median time and median tour length with baseline. Increase larger than tolerance is a regression, times
+ * shorter than MIN_COMPARED_TIME in both are not compared.
+ *
+ * @param results Results of the benchmark
+ * @param baseline Baseline results
+ * @param tolerance Allowed increase in percent
+ * @return Number of regressions
+ */
+int compareWithBaseline(const vector<BenchResult> &results, const map<pair<string, string>, BenchResult> &baseline,
+                        double tolerance) {
+    int regressions = 0;
+    for (const BenchResult &result : results) {
+        auto found = baseline.find(make_pair(result.instance, result.algorithm));
+        if (found == baseline.end()) {
+            cerr << result.instance << " " << result.algorithm << " not in baseline" << endl;
+            continue;
+        }
+        const BenchResult &before = found->second;
+        double timeChange = change(before.time.median, result.time.median);
+        double lengthChange = change(before.length.median, result.length.median);
+        bool timeRegression = timeChange > tolerance &&
+                              max(before.time.median, result.time.median) >= MIN_COMPARED_TIME;
+        bool lengthRegression = lengthChange > tolerance;
+        cerr << result.instance << " " << result.algorithm << " time " << before.time.median << "s -> "
+             << result.time.median << "s (" << showpos << timeChange << "%" << noshowpos << ") length "
+             << before.length.median << " -> " << result.length.median << " (" << showpos << lengthChange << "%"
+             << noshowpos << ")" << (timeRegression || lengthRegression ? " REGRESSION" : "") << endl;
+        if (timeRegression || lengthRegression) regressions++;
+    }
+    return regressions;
+}
+
+/**
+ * Prints supported options.
+ */
+void printUsage() {
+    cerr << "Usage: tsp_bench [options]\n"
+            "  --instances <a,b,...>    Instances from samples directory, all of them by default\n"
+            "  --algorithms <A,B,...>   Algorithm codes, all of them by default\n"
+            "  --runs <n>               Runs of every algorithm on every instance (" << DEFAULT_RUNS << ")\n"
+            "  --seed <n>               Seed of first run, run i uses seed + i (" << DEFAULT_SEED << ")\n"
+            "  --time-limit <seconds>   Time budget of every run (" << DEFAULT_TIME_LIMIT << ")\n"
+            "  --format <json|csv>      Format of results (json)\n"
+            "  --output <file>          File receiving results, standard output by default\n"
+            "  --compare <file>         CSV baseline, regressions are reported and make exit status 1\n"
+            "  --tolerance <percent>    Allowed increase of median time and length (" << DEFAULT_TOLERANCE << ")\n"
+            "  --max-cities <n>         Larger instances are skipped (" << MATRIX_CITIES << ")\n";
+}
+
+/**
+ * Parses command line options.
+ *
+ * @param argc Number of arguments
+ * @param argv Arguments
+ * @param options Parsed options
+ * @return False if options are invalid
+ */
+bool parseBenchOptions(int argc, char *argv[], BenchOptions &options) {
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        if (i + 1 >= argc) return false;
+        string value = argv[++i];
+        char *end;
+        if (option == "--instances") {
+            options.instances = split(value, ',');
+        } else if (option == "--algorithms") {
+            options.algorithms = split(value, ',');
+            for (const string &algorithm : options.algorithms) {
+                if (find(ALL_ALGORITHMS.begin(), ALL_ALGORITHMS.end(), algorithm) == ALL_ALGORITHMS.end()) {
+                    return false;
+                }
+            }
+        } else if (option == "--runs") {
+            options.runs = (int) strtol(value.c_str(), &end, 10);
+            if (*end != '\0' || options.runs <= 0) return false;
+        } else if (option == "--seed") {
+            options.seed = strtoul(value.c_str(), &end, 10);
+            if (*end != '\0') return false;
+        } else if (option == "--time-limit") {
+            options.timeLimit = strtod(value.c_str(), &end);
+            if (*end != '\0' || options.timeLimit <= 0) return false;
+        } else if (option == "--format") {
+            options.format = value;
+            if (value != "json" && value != "csv") return false;
+        } else if (option == "--output") {
+            options.output = value;
+        } else if (option == "--compare") {
+            options.baseline = value;
+        } else if (option == "--tolerance") {
+            options.tolerance = strtod(value.c_str(), &end);
+            if (*end != '\0' || options.tolerance < 0) return false;
+        } else if (option == "--max-cities") {
+            options.maxCities = (int) strtol(value.c_str(), &end, 10);
+            if (*end != '\0' || options.maxCities <= 0) return false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Benchmark of algorithms from runSpecific on sample instances, run from directory containing samples.
+ */
+int main(int argc, char *argv[]) {
+    BenchOptions options;
+    if (!parseBenchOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+    if (options.instances.empty()) options.instances = sampleInstances();
+
+    map<pair<string, string>, BenchResult> baseline;
+    if (!options.baseline.empty() && !readBaseline(options.baseline, baseline)) {
+        cerr << "Can not read baseline " << options.baseline << endl;
+        return 2;
+    }
+
+    vector<BenchResult> results;
+    for (const string &instance : options.instances) {
+        benchInstance(instance, options, results);
+    }
+
+    ofstream file;
+    if (!options.output.empty()) file.open(options.output);
+    ostream &out = options.output.empty() ? cout : file;
+    if (options.format == "csv") {
+        writeCsv(out, results);
+    } else {
+        writeJson(out, options, results);
+    }
+
+    if (!options.baseline.empty() && compareWithBaseline(results, baseline, options.tolerance) > 0) return 1;
+    return 0;
+}
@@ -33,7 +33,7 @@ string getTime() {
  *
  * @param solution Solution as vector of indices
  * @param distance Distance of route
- * @param runningTime Running time in algorithm
+ * @param runningTime Running time in algorithm in seconds
  * @param instance Instance of TSP problem
  * @param algorithm Algorithm used to solve TSP
  * @return name of log file
@@ -53,7 +53,7 @@ string logSolution(const vector<int> &solution, int distance, double runningTime
         f << solution[i] << endl;
     }
     f << distance << endl;
-    f << runningTime / CLOCKS_PER_SEC << endl;
+    f << runningTime << endl;
     f << instance << endl;
     f << algorithm << endl;
     f.close();